@@ -0,0 +1,487 @@
+#ifndef allocation_h
+#define allocation_h
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+/*
+ Учет выделений памяти: число, байты, освобождения, пик живой памяти и гистограмма размеров по именованным областям.
+ Глобальные operator new/delete заменяются, если перед подключением в ОДНОЙ единице трансляции определен ALLOCATION_REPLACE_NEW
+ (замена operator new не может быть inline). Без него ALLOCATION::Allocate/Deallocate можно вызывать из своего operator new.
+ Область: SCOPE("getDerived1") - до конца блока выделения потока относятся к "getDerived1" (вложенные области - к самой внутренней),
+ освобождение относится к области, в которой память выделена. Области с одинаковым именем объединяются.
+ Каждый поток пишет в свои счетчики (как COUNTER::Counter), поэтому число выделений, байты и гистограмма не создают общей кэш-линии между потоками,
+ слот завершенного потока переходит следующему (как кольца COLLECTOR::Collector).
+ Живая память и ее пик - общие для процесса (своя кэш-линия на область, одна атомарная операция на выделение и освобождение):
+ память, выделенная в одном потоке и освобожденная в другом, учитывается верно.
+ Освобождения после того, как поток вернул свой слот (деструкторы thread_local при завершении потока), меняют только живую память.
+ #define ALLOCATION_REPLACE_NEW
+ #include "allocation.h"
+ {
+     SCOPE("getDerived3");
+     Derived derived = getDerived3();
+ }
+ ALLOCATION::Get("getDerived3").count; // 0 - перемещение без выделения памяти
+ */
+namespace ALLOCATION
+{
+    constexpr std::size_t SITES = 64;   // Наибольшее число областей, 0 - все выделения (Total)
+    constexpr std::size_t BUCKETS = 32; // Гистограмма: корзина i - размеры (2^(i-1), 2^i], последняя - все большие
+
+    struct Statistics
+    {
+        std::size_t count = 0;      // Выделений
+        std::size_t bytes = 0;      // Выделено байт
+        std::size_t frees = 0;      // Освобождений
+        std::size_t freedBytes = 0; // Освобождено байт
+        std::size_t peak = 0;       // Пик живой памяти в байтах по всему процессу
+        std::array<std::size_t, BUCKETS> histogram{};
+
+        /// Байты, выделенные и еще не освобожденные
+        std::ptrdiff_t Live() const noexcept { return static_cast<std::ptrdiff_t>(bytes - freedBytes); }
+
+        /// Разность счетчиков, peak остается от lhs
+        friend Statistics operator-(Statistics lhs, const Statistics& rhs) noexcept
+        {
+            lhs.count -= rhs.count;
+            lhs.bytes -= rhs.bytes;
+            lhs.frees -= rhs.frees;
+            lhs.freedBytes -= rhs.freedBytes;
+            for (std::size_t i = 0; i < BUCKETS; ++i)
+                lhs.histogram[i] -= rhs.histogram[i];
+            return lhs;
+        }
+    };
+
+    /// Верхняя граница корзины гистограммы в байтах
+    constexpr std::size_t Bound(std::size_t bucket) noexcept
+    {
+        return std::size_t{1} << bucket;
+    }
+
+    constexpr std::size_t Bucket(std::size_t size) noexcept
+    {
+        return size ? std::min<std::size_t>(BUCKETS - 1, std::bit_width(size - 1)) : 0;
+    }
+    static_assert(Bucket(1) == 0 && Bucket(2) == 1 && Bucket(3) == 2 && Bucket(4) == 2 && Bucket(5) == 3);
+
+    namespace detail
+    {
+        /// Перед каждым блоком: размер, смещение до начала блока malloc и область для освобождения
+        struct Header
+        {
+            std::uint64_t size;
+            std::uint32_t offset;
+            std::uint32_t site;
+        };
+        static_assert(sizeof(Header) == 16 && __STDCPP_DEFAULT_NEW_ALIGNMENT__ % alignof(Header) == 0);
+
+        constexpr std::size_t HEADER = std::max<std::size_t>(sizeof(Header), __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+        /// Счетчики одной области в одном потоке, пишет только владелец, читают все
+        struct Counters
+        {
+            std::atomic<std::size_t> count{0};
+            std::atomic<std::size_t> bytes{0};
+            std::atomic<std::size_t> frees{0};
+            std::atomic<std::size_t> freedBytes{0};
+            std::array<std::atomic<std::size_t>, BUCKETS> histogram{};
+        };
+
+        /// Живая память области по всему процессу: освобождение в любом потоке уменьшает ту же величину
+        struct alignas(64) Live
+        {
+            std::atomic<std::ptrdiff_t> bytes{0};
+            std::atomic<std::ptrdiff_t> peak{0};
+        };
+
+        inline std::array<Live, SITES> lives;
+
+        struct Slot
+        {
+            std::array<Counters, SITES> sites;
+            std::atomic<bool> owned{true};
+            Slot* next = nullptr;
+        };
+
+        template <class T>
+        void Increment(std::atomic<T>& counter, T value) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        inline std::atomic<Slot*> head{nullptr};
+
+        /// Слот завершенного потока или новый, выделенный через malloc (operator new сам попадает сюда), слоты не освобождаются
+        inline Slot* Acquire() noexcept
+        {
+            for (Slot* slot = head.load(std::memory_order_acquire); slot; slot = slot->next)
+            {
+                bool owned = false;
+                if (!slot->owned.load(std::memory_order_relaxed) && slot->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                    return slot;
+            }
+
+            void* memory = std::malloc(sizeof(Slot));
+            if (!memory)
+                std::abort();
+            Slot* slot = ::new (memory) Slot;
+            slot->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed));
+            return slot;
+        }
+
+        /// Слот потока без деструктора - доступ без проверки инициализации, returned - слот уже отдан при завершении потока
+        struct Thread
+        {
+            Slot* slot;
+            bool returned;
+        };
+
+        inline Thread& LocalThread() noexcept
+        {
+            thread_local Thread thread{};
+            return thread;
+        }
+
+        /// Возвращает слот при завершении потока, счетчики сохраняются и продолжаются следующим потоком
+        struct Owner
+        {
+            ~Owner()
+            {
+                Thread& thread = LocalThread();
+                if (thread.slot)
+                    thread.slot->owned.store(false, std::memory_order_release);
+                thread = Thread{nullptr, true}; // Слот может достаться другому потоку: дальше этот поток в него не пишет
+            }
+        };
+
+        /// Owner регистрируется один раз при первом выделении потока, nullptr - поток завершается и уже вернул слот
+        inline Slot* Local() noexcept
+        {
+            Thread& thread = LocalThread();
+            if (!thread.slot && !thread.returned)
+            {
+                thread.slot = Acquire();
+                thread_local Owner owner;
+                (void)owner;
+            }
+            return thread.slot;
+        }
+
+        /// Текущая область потока, 0 - вне областей
+        inline std::uint32_t& Current() noexcept
+        {
+            thread_local std::uint32_t current = 0;
+            return current;
+        }
+
+        struct Names
+        {
+            std::mutex mutex;
+            std::array<const char*, SITES> names{"total"};
+            std::atomic<std::uint32_t> count{1};
+        };
+
+        inline Names& Registry() noexcept
+        {
+            static Names names;
+            return names;
+        }
+
+        inline void Record(Slot* slot, std::uint32_t site, std::size_t size) noexcept
+        {
+            Live& live = lives[site];
+            const std::ptrdiff_t bytes = live.bytes.fetch_add(static_cast<std::ptrdiff_t>(size), std::memory_order_relaxed) + static_cast<std::ptrdiff_t>(size);
+            std::ptrdiff_t peak = live.peak.load(std::memory_order_relaxed);
+            while (bytes > peak && !live.peak.compare_exchange_weak(peak, bytes, std::memory_order_relaxed));
+
+            if (!slot)
+                return;
+            Counters& counters = slot->sites[site];
+            Increment<std::size_t>(counters.count, 1);
+            Increment(counters.bytes, size);
+            Increment<std::size_t>(counters.histogram[Bucket(size)], 1);
+        }
+
+        inline void Release(Slot* slot, std::uint32_t site, std::size_t size) noexcept
+        {
+            lives[site].bytes.fetch_sub(static_cast<std::ptrdiff_t>(size), std::memory_order_relaxed);
+
+            if (!slot)
+                return;
+            Counters& counters = slot->sites[site];
+            Increment<std::size_t>(counters.frees, 1);
+            Increment(counters.freedBytes, size);
+        }
+
+        inline std::uint32_t Find(const char* name) noexcept
+        {
+            const Names& registry = Registry();
+            const std::uint32_t count = registry.count.load(std::memory_order_acquire);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                if (!std::strcmp(registry.names[i], name))
+                    return i;
+            }
+            return SITES;
+        }
+    }
+
+    /// Имя области, регистрируется один раз (SCOPE создает static Site), при переполнении SITES выделения идут только в total
+    class Site
+    {
+    public:
+        explicit Site(const char* name) noexcept
+        {
+            auto& registry = detail::Registry();
+            std::lock_guard lock(registry.mutex);
+            _index = detail::Find(name);
+            if (_index != SITES)
+                return;
+
+            const std::uint32_t count = registry.count.load(std::memory_order_relaxed);
+            _index = count < SITES ? count : 0;
+            if (_index)
+            {
+                registry.names[_index] = name;
+                registry.count.store(count + 1, std::memory_order_release);
+            }
+        }
+
+        std::uint32_t Index() const noexcept { return _index; }
+
+    private:
+        std::uint32_t _index = 0;
+    };
+
+    /// Выделения текущего потока до конца блока относятся к site
+    class Scope
+    {
+    public:
+        explicit Scope(const Site& site) noexcept :
+        _previous(detail::Current())
+        {
+            detail::Current() = site.Index();
+        }
+
+        ~Scope()
+        {
+            detail::Current() = _previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const std::uint32_t _previous;
+    };
+
+    /// nullptr - нет памяти
+    inline void* Allocate(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept
+    {
+        const std::size_t offset = std::max(alignment, detail::HEADER);
+#if defined(_MSC_VER)
+        // В MSVC нет std::aligned_alloc, а блок _aligned_malloc нельзя освободить через std::free: запас alignment - 1 байт и выравнивание вручную
+        void* memory = std::malloc(offset + size + (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? 0 : alignment - 1));
+#else
+        void* memory = alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? std::malloc(offset + size)
+                                                                     : std::aligned_alloc(alignment, (offset + size + alignment - 1) / alignment * alignment);
+#endif
+        if (!memory)
+            return nullptr;
+
+        const std::uint32_t site = detail::Current();
+        auto* pointer = static_cast<unsigned char*>(memory) + offset;
+        pointer += (alignment - reinterpret_cast<std::uintptr_t>(pointer) % alignment) % alignment; // Без MSVC блок уже выровнен
+        ::new (pointer - sizeof(detail::Header)) detail::Header{size, static_cast<std::uint32_t>(pointer - static_cast<unsigned char*>(memory)), site};
+
+        detail::Slot* slot = detail::Local();
+        detail::Record(slot, 0, size);
+        if (site)
+            detail::Record(slot, site, size);
+        return pointer;
+    }
+
+    /// Только для памяти из Allocate()
+    inline void Deallocate(void* pointer) noexcept
+    {
+        if (!pointer)
+            return;
+
+        auto* block = static_cast<unsigned char*>(pointer);
+        const auto* header = std::launder(reinterpret_cast<const detail::Header*>(block - sizeof(detail::Header)));
+        const auto size = static_cast<std::size_t>(header->size);
+        const std::uint32_t site = header->site;
+        const std::uint32_t offset = header->offset;
+
+        detail::Slot* slot = detail::Local();
+        detail::Release(slot, 0, size);
+        if (site)
+            detail::Release(slot, site, size);
+        std::free(block - offset);
+    }
+
+    /// Сумма по потокам, index из Site::Index(), 0 - все выделения
+    inline Statistics Get(std::uint32_t index) noexcept
+    {
+        Statistics statistics;
+        if (index >= SITES)
+            return statistics;
+
+        for (detail::Slot* slot = detail::head.load(std::memory_order_acquire); slot; slot = slot->next)
+        {
+            const detail::Counters& counters = slot->sites[index];
+            statistics.count += counters.count.load(std::memory_order_relaxed);
+            statistics.bytes += counters.bytes.load(std::memory_order_relaxed);
+            statistics.frees += counters.frees.load(std::memory_order_relaxed);
+            statistics.freedBytes += counters.freedBytes.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < BUCKETS; ++i)
+                statistics.histogram[i] += counters.histogram[i].load(std::memory_order_relaxed);
+        }
+        statistics.peak = static_cast<std::size_t>(std::max<std::ptrdiff_t>(0, detail::lives[index].peak.load(std::memory_order_relaxed)));
+        return statistics;
+    }
+
+    /// Пустая статистика, если области с таким именем еще не было
+    inline Statistics Get(const char* name) noexcept
+    {
+        return Get(detail::Find(name));
+    }
+
+    inline Statistics Total() noexcept
+    {
+        return Get(0u);
+    }
+
+    inline std::ostream& operator<<(std::ostream& stream, const Statistics& statistics)
+    {
+        stream << "allocations: " << statistics.count << ", bytes: " << statistics.bytes
+               << ", frees: " << statistics.frees << ", live: " << statistics.Live() << ", peak: " << statistics.peak;
+        if (statistics.count)
+        {
+            stream << ", sizes:";
+            for (std::size_t i = 0; i < BUCKETS; ++i)
+            {
+                if (statistics.histogram[i])
+                    stream << " <=" << Bound(i) << ':' << statistics.histogram[i];
+            }
+        }
+        return stream;
+    }
+
+    /// Все области, включая total
+    inline void Print(std::ostream& stream)
+    {
+        const auto& registry = detail::Registry();
+        const std::uint32_t count = registry.count.load(std::memory_order_acquire);
+        for (std::uint32_t i = 0; i < count; ++i)
+            stream << registry.names[i] << ": " << Get(i) << '\n';
+    }
+}
+
+#define ALLOCATION_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define ALLOCATION_CONCAT(lhs, rhs) ALLOCATION_CONCAT_IMPL(lhs, rhs)
+/// Именованная область до конца блока: SCOPE("getDerived1");
+#define SCOPE(name) \
+    static const ALLOCATION::Site ALLOCATION_CONCAT(allocationSite, __LINE__)(name); \
+    const ALLOCATION::Scope ALLOCATION_CONCAT(allocationScope, __LINE__)(ALLOCATION_CONCAT(allocationSite, __LINE__))
+
+#if defined(ALLOCATION_REPLACE_NEW)
+
+void* operator new(std::size_t size)
+{
+    if (void* pointer = ALLOCATION::Allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = ALLOCATION::Allocate(size, static_cast<std::size_t>(alignment)))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ALLOCATION::Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return ALLOCATION::Allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    ALLOCATION::Deallocate(pointer);
+}
+
+#endif
+
+#endif /* allocation_h */
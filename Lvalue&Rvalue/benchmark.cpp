@@ -0,0 +1,1540 @@
+#define TRACE_MODE TRACE_COUNTERS // Без вывода в std::cout, только счетчики для отчета
+#define ALLOCATION_REPLACE_NEW // Подсчет выделений памяти для отчета
+
+#include "benchmark.h"
+#include "budget.h"
+#include "cow.h"
+#include "elision.h"
+#include "forward.h"
+#include "generator.h"
+#include "ingest.h"
+#include "invoke.h"
+#include "payload.h"
+#include "pmr.h"
+#include "pool.h"
+#include "queue.h"
+#include "relocate.h"
+#include "serialize.h"
+#include "soa.h"
+#include "swap.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+/*
+ Бенчмарк сценариев из main.cpp: время, число копирований, перемещений и выделений памяти на одну операцию.
+ Сборка: g++ -std=c++20 -O2 benchmark.cpp -o benchmark
+ Запуск: ./benchmark [--format csv|json|table] [--iterations N] [--elements N] [--threads N] [--output FILE] [GROUP...]
+ */
+
+namespace
+{
+    using namespace BENCHMARK;
+
+    struct Options
+    {
+        std::size_t iterations = 100000; // Повторений операции в сценариях Measure()
+        std::size_t elements = 1000000;  // Элементов в контейнере в сценариях Process()
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency()); // Наибольшее число потоков в сценариях WORKLOAD
+    };
+
+    /// Сценарии lvalue_rvalue: возврат из функций и emplace_back
+    void LvalueRvalue(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t iterations = options.iterations;
+        using namespace lvalue_rvalue;
+
+        const auto none = [] { return 0; };
+
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived derived = getDerived1()", iterations, none,
+                                           [](int&) { Derived derived = getDerived1(); DoNotOptimize(derived); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived derived = getDerived2()", iterations, none,
+                                           [](int&) { Derived derived = getDerived2(); DoNotOptimize(derived); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived derived = getDerived3()", iterations, none,
+                                           [](int&) { Derived derived = getDerived3(); DoNotOptimize(derived); }));
+
+        /// _text длиннее SSO: копирование выделяет память, перемещение - нет
+        const auto text = []
+        {
+            Derived derived;
+            derived._text = std::string(64, 't');
+            return derived;
+        };
+
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived derived(other) long text", iterations, text,
+                                           [](Derived& other) { Derived derived(other); DoNotOptimize(derived); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived derived(std::move(other)) long text", iterations, text,
+                                           [](Derived& other) { Derived derived(std::move(other)); DoNotOptimize(derived); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "derived = std::move(other) long text", iterations,
+                                           [&text] { return std::make_pair(Derived(), text()); },
+                                           [](auto& deriveds) { deriveds.first = std::move(deriveds.second); }));
+
+        /// Ref-qualified GetText(): && перемещает строку, const && и const & копируют
+        results.push_back(Measure<Derived>("lvalue_rvalue", "std::string text = derived.GetText() long text", iterations, text,
+                                           [](Derived& derived) { std::string copy = std::as_const(derived).GetText(); DoNotOptimize(copy); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "std::string text = std::move(derived).GetText() long text", iterations, text,
+                                           [](Derived& derived) { std::string moved = std::move(derived).GetText(); DoNotOptimize(moved); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "std::string text = std::move(constDerived).GetText() long text", iterations, text,
+                                           [](Derived& derived) { std::string copy = std::move(std::as_const(derived)).GetText(); DoNotOptimize(copy); }));
+        results.push_back(Measure<Derived>("lvalue_rvalue", "std::string text = std::move(derived).ExtractText() long text", iterations, text,
+                                           [](Derived& derived) { std::string extracted = std::move(derived).ExtractText(); DoNotOptimize(extracted); }));
+        /// Цепочка на временном объекте: выделяется память только под исходную строку
+        results.push_back(Measure<Derived>("lvalue_rvalue", "Derived().SetText(text).SetNumber(7).GetText() long text", iterations,
+                                           [] { return std::string(64, 't'); },
+                                           [](std::string& text)
+                                           {
+                                               std::string result = Derived().SetText(std::move(text)).SetNumber(7).GetText();
+                                               DoNotOptimize(result);
+                                           }));
+
+        struct Emplace
+        {
+            std::vector<Derived> deriveds;
+            Derived derived;
+        };
+
+        /// Вызывается конструктор перемещения (reserve(1))
+        results.push_back(Measure<Derived>("lvalue_rvalue", "deriveds.emplace_back(std::move(derived)) reserve", iterations,
+                                           [] { Emplace state; state.deriveds.reserve(1); return state; },
+                                           [](Emplace& state) { state.deriveds.emplace_back(std::move(state.derived)); }));
+        /// Конструктор перемещения нового элемента и перенос старого при выделении памяти
+        results.push_back(Measure<Derived>("lvalue_rvalue", "deriveds.emplace_back(std::move(derived)) grow", iterations,
+                                           [] { Emplace state; state.deriveds.emplace_back(); state.deriveds.shrink_to_fit(); return state; },
+                                           [](Emplace& state) { state.deriveds.emplace_back(std::move(state.derived)); }));
+        /// Вызов конструктора копирования для const объекта
+        results.push_back(Measure<Derived>("lvalue_rvalue", "deriveds.emplace_back(std::move(derivedRef)) const", iterations,
+                                           [] { Emplace state; state.deriveds.reserve(1); return state; },
+                                           [](Emplace& state)
+                                           {
+                                               const Derived& derivedRef = state.derived;
+                                               state.deriveds.emplace_back(std::move(derivedRef));
+                                           }));
+    }
+
+    /// Большой объект без динамической памяти, перемещение равно копированию
+    struct Payload
+    {
+        std::array<char, 4096> data{};
+    };
+
+    /// swap_old (копирование), swap_move (перемещение), SWAP::swap (выбор по свойствам типа) и std::swap для пары объектов из setup
+    template <class... Types, class Setup>
+    void Swaps(std::vector<Result>& results, std::size_t iterations, const std::string& name, Setup setup)
+    {
+        results.push_back(Measure<Types...>("swap", "swap_old(" + name + ")", iterations, setup,
+                                            [](auto& pair) { SWAP::swap_old(pair.first, pair.second); }));
+        results.push_back(Measure<Types...>("swap", "swap_move(" + name + ")", iterations, setup,
+                                            [](auto& pair) { SWAP::swap_move(pair.first, pair.second); }));
+        results.push_back(Measure<Types...>("swap", "SWAP::swap(" + name + ")", iterations, setup,
+                                            [](auto& pair) { SWAP::swap(pair.first, pair.second); }));
+        results.push_back(Measure<Types...>("swap", "std::swap(" + name + ")", iterations, setup,
+                                            [](auto& pair) { std::swap(pair.first, pair.second); }));
+    }
+
+    /// Сценарии SWAP: копирование, перемещение, выбор способа по свойствам типа и std::swap
+    void Swap(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t iterations = options.iterations;
+        const std::size_t large = iterations / 100 ? iterations / 100 : 1;
+
+        using Strings = std::pair<std::string, std::string>;
+        using Vectors = std::pair<std::vector<int>, std::vector<int>>;
+        using Deriveds = std::pair<lvalue_rvalue::Derived, lvalue_rvalue::Derived>;
+        using Payloads = std::pair<Payload, Payload>;
+        struct Arrays
+        {
+            int first[1024];
+            int second[1024];
+        };
+
+        Swaps(results, iterations, "std::string short", [] { return Strings("str1", "str2"); });
+        Swaps(results, large, "std::string 64KB", [] { return Strings(std::string(1 << 16, '1'), std::string(1 << 16, '2')); });
+        Swaps(results, large, "std::vector<int> 1024", [] { return Vectors(std::vector<int>(1024, 1), std::vector<int>(1024, 2)); });
+        Swaps<lvalue_rvalue::Derived>(results, iterations, "Derived", [] { return Deriveds(); });
+        Swaps(results, large, "Payload 4KB", [] { return Payloads(); });
+
+        results.push_back(Measure<>("swap", "SWAP::swap(int[1024])", large, [] { return Arrays(); },
+                                    [](Arrays& arrays) { SWAP::swap(arrays.first, arrays.second); }));
+        results.push_back(Measure<>("swap", "std::swap(int[1024])", large, [] { return Arrays(); },
+                                    [](Arrays& arrays) { std::swap(arrays.first, arrays.second); }));
+        results.push_back(Measure<lvalue_rvalue::Derived>("swap", "SWAP::swap_ranges(Derived[64])", large,
+                                                          [] { return std::pair<std::vector<lvalue_rvalue::Derived>, std::vector<lvalue_rvalue::Derived>>(64, 64); },
+                                                          [](auto& pair) { SWAP::swap_ranges(pair.first.data(), pair.first.data() + 64, pair.second.data()); }));
+        results.push_back(Measure<lvalue_rvalue::Derived>("swap", "std::swap_ranges(Derived[64])", large,
+                                                          [] { return std::pair<std::vector<lvalue_rvalue::Derived>, std::vector<lvalue_rvalue::Derived>>(64, 64); },
+                                                          [](auto& pair) { std::swap_ranges(pair.first.begin(), pair.first.end(), pair.second.begin()); }));
+    }
+
+    /// Превышен хотя бы один бюджет BUDGET - бенчмарк завершается с ошибкой (проверка в ctest)
+    bool budgetExceeded = false;
+
+    void Verify(const BUDGET::Report& report)
+    {
+        if (!report)
+        {
+            std::cerr << report;
+            budgetExceeded = true;
+        }
+    }
+
+    /*
+     Вызывает фабрику для lvalue, const lvalue, rvalue и const rvalue аргумента FORWARD::A.
+     Каждая категория сначала проверяется одним вызовом BUDGET::Expect: lvalue и const - одно копирование,
+     rvalue - бюджет фабрики (перемещение при идеальной передаче), лишнее копирование - ошибка бенчмарка.
+     */
+    template <class Factory>
+    void Categories(std::vector<Result>& results, std::size_t iterations, const std::string& name, BUDGET::Budget rvalue, Factory factory)
+    {
+        using FORWARD::A;
+
+        const auto setup = [] { return A(); };
+        const auto category = [&](const std::string& scenario, BUDGET::Budget budget, auto run)
+        {
+            Verify(BUDGET::Expect<A>(name + scenario, budget, [&run] { A a; run(a); }));
+            results.push_back(Measure<A>("forward", name + scenario, iterations, setup, run));
+        };
+
+        category("(a)", {.copies = 1, .moves = 0},
+                 [&factory](A& a) { auto pointer = factory(a); DoNotOptimize(pointer); });
+        category("(constA)", {.copies = 1, .moves = 0},
+                 [&factory](A& a) { const A& constA = a; auto pointer = factory(constA); DoNotOptimize(pointer); });
+        category("(std::move(a))", rvalue,
+                 [&factory](A& a) { auto pointer = factory(std::move(a)); DoNotOptimize(pointer); });
+        category("(std::move(constA))", {.copies = 1, .moves = 0},
+                 [&factory](A& a) { const A& constA = a; auto pointer = factory(std::move(constA)); DoNotOptimize(pointer); });
+    }
+
+    /// Сценарии FORWARD: Make_Shared против семейства фабрик с идеальной передачей
+    void Forward(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t iterations = options.iterations;
+        using namespace FORWARD;
+
+        /// Пул переиспользует освобожденные блоки, поэтому выделений из глобальной памяти почти нет
+        std::pmr::unsynchronized_pool_resource arena;
+
+        /// Make_Shared без std::forward: rvalue внутри - lvalue, поэтому копируется
+        Categories(results, iterations, "Make_Shared<A>", {.copies = 1, .moves = 0},
+                   [](auto&& a) { return Make_Shared<A>(std::forward<decltype(a)>(a)); });
+        Categories(results, iterations, "Make_Shared_Forward<A>", {.copies = 0, .moves = 1},
+                   [](auto&& a) { return Make_Shared_Forward<A>(std::forward<decltype(a)>(a)); });
+        Categories(results, iterations, "Make_Unique<A>", {.copies = 0, .moves = 1},
+                   [](auto&& a) { return Make_Unique<A>(std::forward<decltype(a)>(a)); });
+        Categories(results, iterations, "Allocate_Shared<A>", {.copies = 0, .moves = 1},
+                   [](auto&& a) { return Allocate_Shared<A>(std::allocator<A>(), std::forward<decltype(a)>(a)); });
+        Categories(results, iterations, "Make_Shared_Arena<A>", {.copies = 0, .moves = 1},
+                   [&arena](auto&& a) { return Make_Shared_Arena<A>(&arena, std::forward<decltype(a)>(a)); });
+    }
+
+    /// Сценарии PMR: построение, рост и уничтожение вектора из options.elements объектов с обычным аллокатором и с ареной
+    void Pmr(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t elements = options.elements;
+        const std::string longText(64, 't'); // Длиннее SSO: строка в динамической памяти
+
+        results.push_back(Process<lvalue_rvalue::Derived>("pmr", "std::vector<Derived> grow", elements, [elements]
+        {
+            std::vector<lvalue_rvalue::Derived> deriveds;
+            for (std::size_t i = 0; i < elements; ++i)
+                deriveds.emplace_back();
+            DoNotOptimize(deriveds.data());
+        }));
+
+        for (const std::string& text : {std::string("text"), longText})
+        {
+            const std::string suffix = text.size() > 15 ? " long text" : " short text";
+
+            /// resource == nullptr - арена создается внутри замера, чтобы ее освобождение тоже попало в замер
+            const auto vector = [&](const std::string& name, bool reserve, auto makeResource)
+            {
+                results.push_back(Process<PMR::Derived>("pmr", name + (reserve ? " reserve" : " grow") + suffix, elements, [&]
+                {
+                    auto resource = makeResource();
+                    std::pmr::vector<PMR::Derived> deriveds(resource.get());
+                    if (reserve)
+                        deriveds.reserve(elements);
+                    for (std::size_t i = 0; i < elements; ++i)
+                        deriveds.emplace_back(text);
+                    DoNotOptimize(deriveds.data());
+                }));
+            };
+
+            for (bool reserve : {false, true})
+            {
+                vector("new_delete_resource", reserve, []
+                {
+                    return std::unique_ptr<std::pmr::memory_resource, void (*)(std::pmr::memory_resource*)>(std::pmr::new_delete_resource(), [](std::pmr::memory_resource*) {});
+                });
+                vector("monotonic_buffer_resource", reserve, []
+                {
+                    return std::make_unique<std::pmr::monotonic_buffer_resource>();
+                });
+                vector("unsynchronized_pool_resource", reserve, []
+                {
+                    return std::make_unique<std::pmr::unsynchronized_pool_resource>();
+                });
+            }
+        }
+    }
+
+    /// Рост, вставка в середину и удаление из середины контейнера из 1000 элементов
+    template <class Container>
+    void Relocations(std::vector<Result>& results, std::size_t iterations, const std::string& name)
+    {
+        using T = typename Container::value_type;
+        constexpr std::size_t size = 1000;
+
+        const auto filled = [](std::size_t capacity)
+        {
+            return [capacity]
+            {
+                Container container;
+                container.reserve(capacity);
+                for (std::size_t i = 0; i < size; ++i)
+                    container.emplace_back();
+                return container;
+            };
+        };
+
+        results.push_back(Measure<T>("relocate", name + " reallocation", iterations, filled(size),
+                                     [](Container& container) { container.emplace_back(); }));
+        // std::vector сдвигает элементы присваиванием перемещением, у FORWARD::A его нет
+        if constexpr (std::is_move_assignable_v<T> || std::is_same_v<Container, RELOCATE::Vector<T>>)
+        {
+            results.push_back(Measure<T>("relocate", name + " insert middle", iterations, filled(size * 2),
+                                         [](Container& container) { container.emplace(container.begin() + size / 2); }));
+            results.push_back(Measure<T>("relocate", name + " erase middle", iterations, filled(size),
+                                         [](Container& container) { container.erase(container.begin() + size / 2); }));
+        }
+    }
+
+    /// Сценарии RELOCATE: std::vector (перемещение + деструктор) против RELOCATE::Vector (memcpy для тривиально релоцируемых типов)
+    void Relocate(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t iterations = options.iterations / 100 ? options.iterations / 100 : 1;
+
+        Relocations<std::vector<lvalue_rvalue::Derived>>(results, iterations, "std::vector<Derived>");
+        Relocations<RELOCATE::Vector<lvalue_rvalue::Derived>>(results, iterations, "RELOCATE::Vector<Derived>");
+        Relocations<std::vector<FORWARD::A>>(results, iterations, "std::vector<A>");
+        Relocations<RELOCATE::Vector<FORWARD::A>>(results, iterations, "RELOCATE::Vector<A>");
+    }
+
+    /// Копирование, перемещение и SWAP::swap BasicDerived<Text> с текстом длины Size
+    template <class Text, std::size_t Size>
+    void Payloads(std::vector<Result>& results, std::size_t iterations, const std::string& name)
+    {
+        using Derived = lvalue_rvalue::BasicDerived<Text>;
+
+        const std::string source(Size, 't');
+        const auto derived = [&source]
+        {
+            Derived derived;
+            derived._text = Text(std::string_view(source));
+            return derived;
+        };
+        const std::string scenario = name + " " + std::to_string(Size) + "B";
+
+        results.push_back(Measure<Derived>("payload", scenario + " copy", iterations, derived,
+                                           [](Derived& other) { Derived copy(other); DoNotOptimize(copy); }));
+        results.push_back(Measure<Derived>("payload", scenario + " move", iterations, derived,
+                                           [](Derived& other) { Derived moved(std::move(other)); DoNotOptimize(moved); }));
+        results.push_back(Measure<Derived>("payload", scenario + " swap", iterations,
+                                           [&derived] { return std::make_pair(derived(), derived()); },
+                                           [](auto& deriveds) { SWAP::swap(deriveds.first, deriveds.second); }));
+    }
+
+    /// Все варианты хранения для одной длины текста, число итераций уменьшается с ростом Size, чтобы состояния помещались в память
+    template <std::size_t Size>
+    void Payloads(std::vector<Result>& results, std::size_t iterations)
+    {
+        iterations = std::max<std::size_t>(1, iterations / (1 + Size / 64));
+
+        Payloads<std::string, Size>(results, iterations, "std::string");
+        Payloads<PAYLOAD::InlineString<Size>, Size>(results, iterations, "PAYLOAD::InlineString<" + std::to_string(Size) + ">");
+        Payloads<PAYLOAD::SmallString<64>, Size>(results, iterations, "PAYLOAD::SmallString<64>");
+        Payloads<PAYLOAD::InternedString, Size>(results, iterations, "PAYLOAD::InternedString");
+    }
+
+    /// Сценарии PAYLOAD: std::string, буфер фиксированного размера, SSO с порогом 64 и строка из пула, текст от 8 байт до 64 КБ
+    void Payload(std::vector<Result>& results, const Options& options)
+    {
+        Payloads<8>(results, options.iterations);
+        Payloads<64>(results, options.iterations);
+        Payloads<512>(results, options.iterations);
+        Payloads<4096>(results, options.iterations);
+        Payloads<65536>(results, options.iterations);
+    }
+
+    /// Одна запись раздается fanout получателям: копия в каждый контейнер, затем изменение одной копии (detach у COW)
+    template <class Derived>
+    void FanOuts(std::vector<Result>& results, std::size_t iterations, const std::string& name, std::size_t size)
+    {
+        const std::string suffix = " " + std::to_string(size) + "B";
+        const std::string text(size, 't');
+        Derived source;
+        source._text = std::string_view(text);
+        const auto shared = [&source] { return &source; };
+
+        for (std::size_t fanout : {1, 10, 100, 1000})
+        {
+            /// std::string: 1000 копий по 1 МБ - гигабайт на итерацию, сценарий пропускается
+            if (std::is_same_v<Derived, lvalue_rvalue::Derived> && fanout * size > (std::size_t{256} << 20))
+                continue;
+
+            results.push_back(Measure<Derived>("cow", name + " fan-out " + std::to_string(fanout) + suffix,
+                                               std::max<std::size_t>(1, iterations / (fanout * (1 + size / 1024))), shared,
+                                               [fanout](const Derived* source)
+                                               {
+                                                   std::vector<Derived> copies;
+                                                   copies.reserve(fanout);
+                                                   for (std::size_t i = 0; i < fanout; ++i)
+                                                       copies.push_back(*source);
+                                                   DoNotOptimize(copies.data());
+                                               }));
+        }
+
+        results.push_back(Measure<Derived>("cow", name + " copy + write" + suffix, std::max<std::size_t>(1, iterations / (1 + size / 1024)), shared,
+                                           [](const Derived* source)
+                                           {
+                                               Derived copy = *source;
+                                               copy._text[0] = 'x';
+                                               DoNotOptimize(copy);
+                                           }));
+    }
+
+    /// Запись завершающего '\0' пустой копии: у COW блока нет, Mutable() выдает общий терминатор, а не nullptr
+    template <class Derived>
+    void EmptyWrite(std::vector<Result>& results, std::size_t iterations, const std::string& name)
+    {
+        Derived source;
+        const auto shared = [&source] { return &source; };
+        results.push_back(Measure<Derived>("cow", name + " copy + write empty", iterations, shared,
+                                           [](const Derived* source)
+                                           {
+                                               Derived copy = *source;
+                                               copy._text[0] = '\0';
+                                               DoNotOptimize(copy);
+                                           }));
+    }
+
+    /// Сценарии COW: std::string против общего блока текста с обычным и атомарным счетчиком ссылок, текст от 16 байт до 1 МБ
+    void Cow(std::vector<Result>& results, const Options& options)
+    {
+        for (std::size_t size : {std::size_t{16}, std::size_t{1024}, std::size_t{64} << 10, std::size_t{1} << 20})
+        {
+            FanOuts<lvalue_rvalue::Derived>(results, options.iterations, "Derived", size);
+            FanOuts<COW::LocalDerived>(results, options.iterations, "COW::LocalDerived", size);
+            FanOuts<COW::Derived>(results, options.iterations, "COW::Derived", size);
+        }
+        EmptyWrite<lvalue_rvalue::Derived>(results, options.iterations, "Derived");
+        EmptyWrite<COW::LocalDerived>(results, options.iterations, "COW::LocalDerived");
+        EmptyWrite<COW::Derived>(results, options.iterations, "COW::Derived");
+    }
+
+    /*
+     Сценарии SOA: проход по _number в std::vector<Derived> (AoS) и в SOA::Vector (SoA) одним и тем же кодом SOA::Sum/MinMax/Filter,
+     строк elements, 10 * elements и 100 * elements (10^6 - 10^8 по умолчанию), размеры, при которых AoS не помещается в 4 ГБ, пропускаются.
+     Числа псевдослучайные, поэтому условие Filter (половина строк) непредсказуемо.
+     */
+    void Soa(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+
+        const auto number = [](std::size_t i) { return static_cast<int>(i * 2654435761u % 1000); };
+        const auto filter = [](int value) { return value < 500; };
+
+        for (std::size_t scale : {std::size_t{1}, std::size_t{10}, std::size_t{100}})
+        {
+            const std::size_t rows = options.elements * scale;
+            if (rows * sizeof(Derived) > (std::size_t{4} << 30))
+                continue;
+
+            const std::string suffix = " " + std::to_string(rows) + " rows";
+            const auto aos = [rows, &number]
+            {
+                std::vector<Derived> deriveds(rows);
+                for (std::size_t i = 0; i < rows; ++i)
+                    deriveds[i]._number = number(i);
+                return deriveds;
+            };
+            const auto soa = [rows, &number]
+            {
+                SOA::Vector<> table;
+                table.reserve(rows);
+                for (std::size_t i = 0; i < rows; ++i)
+                    table.emplace_back(number(i), "text");
+                return table;
+            };
+
+            results.push_back(Process<Derived>("soa", "std::vector<Derived> Sum" + suffix, rows, aos, [](std::vector<Derived>& deriveds)
+            {
+                DoNotOptimize(SOA::Sum(deriveds, &Derived::_number));
+            }));
+            results.push_back(Process<Derived>("soa", "SOA::Vector Sum" + suffix, rows, soa, [](SOA::Vector<>& table)
+            {
+                DoNotOptimize(SOA::Sum(table.numbers()));
+            }));
+            results.push_back(Process<Derived>("soa", "std::vector<Derived> MinMax" + suffix, rows, aos, [](std::vector<Derived>& deriveds)
+            {
+                DoNotOptimize(SOA::MinMax(deriveds, &Derived::_number));
+            }));
+            results.push_back(Process<Derived>("soa", "SOA::Vector MinMax" + suffix, rows, soa, [](SOA::Vector<>& table)
+            {
+                DoNotOptimize(SOA::MinMax(table.numbers()));
+            }));
+            results.push_back(Process<Derived>("soa", "std::vector<Derived> Filter" + suffix, rows, aos, [&filter](std::vector<Derived>& deriveds)
+            {
+                std::vector<std::uint32_t> indices;
+                DoNotOptimize(SOA::Filter(deriveds, filter, indices, &Derived::_number));
+            }));
+            results.push_back(Process<Derived>("soa", "SOA::Vector Filter" + suffix, rows, soa, [&filter](SOA::Vector<>& table)
+            {
+                std::vector<std::uint32_t> indices;
+                DoNotOptimize(SOA::Filter(table.numbers(), filter, indices));
+            }));
+        }
+
+        /// Перемещение строк целиком: в таблицу из Derived и обратно, без копирования текста
+        const std::size_t rows = options.elements;
+        const auto texts = [rows]
+        {
+            std::vector<Derived> deriveds(rows);
+            for (Derived& derived : deriveds)
+                derived._text = std::string(64, 't');
+            return deriveds;
+        };
+        results.push_back(Process<Derived>("soa", "table.push_back(std::move(derived)) long text", rows, texts, [](std::vector<Derived>& deriveds)
+        {
+            SOA::Vector<> table;
+            table.reserve(deriveds.size());
+            for (Derived& derived : deriveds)
+                table.push_back(std::move(derived));
+            DoNotOptimize(table);
+        }));
+        results.push_back(Process<Derived>("soa", "Derived derived = std::move(table)[i] long text", rows, [&texts]
+        {
+            SOA::Vector<> table;
+            for (Derived& derived : texts())
+                table.push_back(std::move(derived));
+            return table;
+        }, [](SOA::Vector<>& table)
+        {
+            for (std::size_t i = 0; i < table.size(); ++i)
+            {
+                Derived derived = std::move(table)[i];
+                DoNotOptimize(derived);
+            }
+        }));
+    }
+
+    /// Временный файл сценария, удаляется вместе с состоянием
+    struct TemporaryFile
+    {
+        explicit TemporaryFile(const std::string& name) :
+        path((std::filesystem::temp_directory_path() / name).string())
+        {
+
+        }
+
+        TemporaryFile(TemporaryFile&& other) noexcept :
+        path(std::exchange(other.path, {}))
+        {
+
+        }
+
+        ~TemporaryFile()
+        {
+            std::error_code error;
+            if (!path.empty())
+                std::filesystem::remove(path, error);
+        }
+
+        std::string path;
+    };
+
+    /*
+     Сценарии SERIALIZE: запись Derived перемещением и загрузка обратно, текст длиннее SSO.
+     Загрузка через View не создает строк: число выделений памяти на запись - 0 против 1 у std::vector<Derived>.
+     Файл после записи в setup лежит в кэше страниц, поэтому замеряется отображение и разбор, а не диск.
+     */
+    void Serialize(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+
+        const std::size_t records = options.elements;
+        const auto deriveds = [records]
+        {
+            std::vector<Derived> deriveds(records);
+            for (std::size_t i = 0; i < records; ++i)
+            {
+                deriveds[i]._number = static_cast<int>(i);
+                deriveds[i]._text = std::string(64, 't');
+            }
+            return deriveds;
+        };
+        const auto file = [&deriveds]
+        {
+            TemporaryFile file("lvalue_rvalue_serialize.bin");
+            SERIALIZE::Writer writer(file.path);
+            for (Derived& derived : deriveds())
+                writer.Write(std::move(derived));
+            writer.Close();
+            return file;
+        };
+
+        struct Source
+        {
+            std::vector<Derived> deriveds;
+            TemporaryFile file;
+        };
+
+        results.push_back(Process<Derived>("serialize", "Writer.Write(std::move(derived)) long text", records, [&deriveds]
+        {
+            return Source{deriveds(), TemporaryFile("lvalue_rvalue_serialize.bin")};
+        }, [](Source& source)
+        {
+            SERIALIZE::Writer writer(source.file.path);
+            for (Derived& derived : source.deriveds)
+                writer.Write(std::move(derived));
+            writer.Close();
+        }));
+        results.push_back(Process<Derived>("serialize", "View(path) open", records, file, [](TemporaryFile& file)
+        {
+            SERIALIZE::View view(file.path);
+            DoNotOptimize(view.size());
+        }));
+        results.push_back(Process<Derived>("serialize", "View(path) GetNumber + GetText().size() long text", records, file, [](TemporaryFile& file)
+        {
+            const SERIALIZE::View view(file.path);
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < view.size(); ++i)
+                sum += static_cast<std::size_t>(view[i].GetNumber()) + view[i].GetText().size();
+            DoNotOptimize(sum);
+        }));
+        results.push_back(Process<Derived>("serialize", "View(path) -> std::vector<Derived> long text", records, file, [](TemporaryFile& file)
+        {
+            const SERIALIZE::View view(file.path);
+            std::vector<Derived> deriveds;
+            deriveds.reserve(view.size());
+            for (std::size_t i = 0; i < view.size(); ++i)
+                deriveds.push_back(view[i].Materialize<Derived>());
+            DoNotOptimize(deriveds.data());
+        }));
+    }
+
+    /// threads потоков, каждый вызывает Policy::Trace iterations раз, события по кругу от конструктора до деструктора
+    template <class Policy>
+    void Traces(std::vector<Result>& results, std::size_t iterations, std::size_t threads, const std::string& name)
+    {
+        results.push_back(Process<>("collector", name + " " + std::to_string(threads) + " threads", iterations * threads, [iterations, threads]
+        {
+            const std::string path = (std::filesystem::temp_directory_path() / "lvalue_rvalue_collector.bin").string();
+            if constexpr (std::is_same_v<Policy, COLLECTOR::Collector>)
+                COLLECTOR::Collector::Start(path);
+
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back([iterations]
+                {
+                    const lvalue_rvalue::Derived derived;
+                    for (std::size_t j = 0; j < iterations; ++j)
+                        Policy::Trace(&derived, static_cast<COUNTER::Event>(j % COUNTER::EVENTS));
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+
+            if constexpr (std::is_same_v<Policy, COLLECTOR::Collector>)
+            {
+                COLLECTOR::Collector::Stop();
+                std::filesystem::remove(path);
+            }
+        }));
+    }
+
+    /// Сценарии COLLECTOR: стоимость события для политик трассировки при 1 и 4 потоках, Console - общий std::cout с блокировкой
+    void Collector(std::vector<Result>& results, const Options& options)
+    {
+        for (const std::size_t threads : {1, 4})
+        {
+            Traces<TRACE::Console>(results, options.iterations, threads, "TRACE::Console");
+            Traces<TRACE::Counters>(results, options.iterations, threads, "TRACE::Counters");
+            Traces<TRACE::Buffered>(results, options.iterations, threads, "TRACE::Buffered");
+            Traces<COLLECTOR::Collector>(results, options.iterations, threads, "COLLECTOR::Collector");
+        }
+    }
+
+    /// Сценарии WORKLOAD для 1, 2, 4 ... options.threads потоков: пропускная способность на поток показывает стоимость масштабирования
+    void Workload(std::vector<Result>& results, const Options& options)
+    {
+        std::vector<std::size_t> counts;
+        for (std::size_t threads = 1; threads < options.threads; threads *= 2)
+            counts.push_back(threads);
+        counts.push_back(options.threads);
+
+        const std::size_t items = options.iterations;
+        const std::string text(64, 't'); // Длиннее SSO: копирование выделяет память
+
+        const auto add = [&results](std::size_t threads, Result result)
+        {
+            result.threads = threads;
+            results.push_back(std::move(result));
+        };
+
+        for (const std::size_t threads : counts)
+        {
+            const std::string suffix = " " + std::to_string(threads) + " threads";
+            const std::size_t pair = std::max<std::size_t>(2, threads); // Хотя бы один производитель и один потребитель
+
+            add(pair, Process<lvalue_rvalue::Derived>("workload", "handoff move" + suffix, items, [=]
+            {
+                DoNotOptimize(WORKLOAD::Handoff(threads, items, WORKLOAD::Transfer::Move, text));
+            }));
+            add(pair, Process<lvalue_rvalue::Derived>("workload", "handoff copy" + suffix, items, [=]
+            {
+                DoNotOptimize(WORKLOAD::Handoff(threads, items, WORKLOAD::Transfer::Copy, text));
+            }));
+            add(threads, Process<lvalue_rvalue::Derived>("workload", "stealing std::unique_ptr" + suffix, items, [=]
+            {
+                DoNotOptimize(WORKLOAD::Stealing(threads, items, text));
+            }));
+            add(threads, Process<lvalue_rvalue::Derived>("workload", "fan-out std::shared_ptr" + suffix, items, [=]
+            {
+                DoNotOptimize(WORKLOAD::FanOut(threads, items, text));
+            }));
+        }
+    }
+
+    /// Базовая очередь для сравнения с QUEUE::Ring: std::deque под std::mutex
+    template <class T>
+    class LockedQueue
+    {
+    public:
+        using value_type = T;
+
+        explicit LockedQueue(std::size_t) {}
+
+        void push(T&& value)
+        {
+            std::lock_guard lock(_mutex);
+            _values.push_back(std::move(value));
+        }
+
+        bool try_pop(T& value)
+        {
+            std::lock_guard lock(_mutex);
+            if (_values.empty())
+                return false;
+
+            value = std::move(_values.front());
+            _values.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::deque<T> _values;
+    };
+
+    /// producers потоков передают items элементов consumers потокам, producers == 0 - push и try_pop по очереди в одном потоке
+    template <class Queue, class Make>
+    void Transfer(std::size_t producers, std::size_t consumers, std::size_t items, Make make)
+    {
+        using T = typename Queue::value_type;
+        Queue queue(1024);
+
+        if (!producers)
+        {
+            T value;
+            for (std::size_t i = 0; i < items; ++i)
+            {
+                queue.push(make());
+                queue.try_pop(value);
+            }
+            DoNotOptimize(value);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < producers; ++i)
+        {
+            threads.emplace_back([&queue, &make, count = items / producers + (i < items % producers ? 1 : 0)]
+            {
+                for (std::size_t j = 0; j < count; ++j)
+                    queue.push(make());
+            });
+        }
+
+        std::atomic<std::size_t> popped{0};
+        for (std::size_t i = 0; i < consumers; ++i)
+        {
+            threads.emplace_back([&queue, &popped, items]
+            {
+                T value;
+                while (popped.load(std::memory_order_relaxed) < items)
+                {
+                    if (queue.try_pop(value))
+                        popped.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+                DoNotOptimize(value);
+            });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    template <class T, class Make>
+    void Queues(std::vector<Result>& results, const Options& options, const std::string& name, Make make)
+    {
+        const std::size_t items = options.iterations;
+        const std::size_t threads = std::max<std::size_t>(2, options.threads);
+        const std::size_t producers = threads / 2;
+        const std::size_t consumers = threads - producers;
+        const std::string suffix = " " + std::to_string(producers) + "P/" + std::to_string(consumers) + "C";
+
+        results.push_back(Process<lvalue_rvalue::Derived>("queue", "QUEUE::Ring<" + name + "> push+pop", items,
+                                                          [=] { Transfer<QUEUE::Ring<T>>(0, 0, items, make); }));
+        results.push_back(Process<lvalue_rvalue::Derived>("queue", "mutex+std::deque<" + name + "> push+pop", items,
+                                                          [=] { Transfer<LockedQueue<T>>(0, 0, items, make); }));
+
+        Result ring = Process<lvalue_rvalue::Derived>("queue", "QUEUE::Ring<" + name + ">" + suffix, items,
+                                                      [=] { Transfer<QUEUE::Ring<T>>(producers, consumers, items, make); });
+        ring.threads = threads;
+        results.push_back(std::move(ring));
+
+        Result locked = Process<lvalue_rvalue::Derived>("queue", "mutex+std::deque<" + name + ">" + suffix, items,
+                                                        [=] { Transfer<LockedQueue<T>>(producers, consumers, items, make); });
+        locked.threads = threads;
+        results.push_back(std::move(locked));
+    }
+
+    /// Сценарии QUEUE: ограниченная MPMC очередь без блокировок против std::deque под std::mutex, элементы только перемещаются
+    void Queue(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+
+        Queues<Derived>(results, options, "Derived", [] { return Derived(); });
+        Queues<std::unique_ptr<Derived>>(results, options, "std::unique_ptr<Derived>", [] { return std::make_unique<Derived>(); });
+        Queues<std::string>(results, options, "std::string", [] { return std::string(64, 't'); });
+    }
+
+    /// Источник конвейера: count объектов Derived с _number = i
+    GENERATOR::Generator<lvalue_rvalue::Derived> Deriveds(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            lvalue_rvalue::Derived derived;
+            derived._number = static_cast<int>(i);
+            co_yield std::move(derived);
+        }
+    }
+
+    /*
+     Сценарии GENERATOR: конвейер из 5 стадий (источник, Map, Filter, Map, Batch(1024)) и то же вычисление,
+     где каждая стадия перемещает все объекты в новый std::vector, а предыдущий освобождается.
+     Конвейер держит в памяти одну пачку, вектор - две стадии целиком (peak_rss_kb), объекты в обоих только перемещаются.
+     */
+    void Generator(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+
+        const std::size_t elements = options.elements;
+        constexpr std::size_t BATCH = 1024;
+        const auto scale = [](Derived&& derived) { derived._number *= 7; return std::move(derived); };
+        const auto keep = [](const Derived& derived) { return derived._number % 3 != 0; };
+        const auto shift = [](Derived&& derived) { derived._number += 1; return std::move(derived); };
+
+        results.push_back(Process<Derived>("generator", "Generator | Map | Filter | Map | Batch", elements, [=]
+        {
+            long long sum = 0;
+            for (std::vector<Derived>&& batch : Deriveds(elements) | GENERATOR::Map(scale) | GENERATOR::Filter(keep) | GENERATOR::Map(shift) | GENERATOR::Batch(BATCH))
+            {
+                for (const Derived& derived : batch)
+                    sum += derived._number;
+            }
+            DoNotOptimize(sum);
+        }));
+
+        results.push_back(Process<Derived>("generator", "std::vector per stage", elements, [=]
+        {
+            /// Каждая стадия перемещает объекты в новый вектор и освобождает предыдущий
+            const auto stage = [](std::vector<Derived>& source, auto&& body)
+            {
+                std::vector<Derived> target;
+                target.reserve(source.size());
+                for (Derived& derived : source)
+                    body(target, std::move(derived));
+                std::vector<Derived>().swap(source);
+                return target;
+            };
+
+            std::vector<Derived> source;
+            source.reserve(elements);
+            for (std::size_t i = 0; i < elements; ++i)
+                source.emplace_back()._number = static_cast<int>(i);
+
+            std::vector<Derived> scaled = stage(source, [&](std::vector<Derived>& target, Derived&& derived) { target.push_back(scale(std::move(derived))); });
+            std::vector<Derived> kept = stage(scaled, [&](std::vector<Derived>& target, Derived&& derived)
+            {
+                if (keep(derived))
+                    target.push_back(std::move(derived));
+            });
+            std::vector<Derived> shifted = stage(kept, [&](std::vector<Derived>& target, Derived&& derived) { target.push_back(shift(std::move(derived))); });
+
+            std::vector<std::vector<Derived>> batches;
+            batches.reserve((shifted.size() + BATCH - 1) / BATCH);
+            for (std::size_t i = 0; i < shifted.size(); i += BATCH)
+                batches.emplace_back(std::make_move_iterator(shifted.begin() + static_cast<std::ptrdiff_t>(i)),
+                                     std::make_move_iterator(shifted.begin() + static_cast<std::ptrdiff_t>(std::min(shifted.size(), i + BATCH))));
+            std::vector<Derived>().swap(shifted);
+
+            long long sum = 0;
+            for (const std::vector<Derived>& batch : batches)
+            {
+                for (const Derived& derived : batch)
+                    sum += derived._number;
+            }
+            DoNotOptimize(sum);
+        }));
+    }
+
+    /// Задержка одной операции run(i): строки p50, p99, p99.9 и max, ns_per_op - значение перцентиля
+    template <class Run>
+    void Latency(std::vector<Result>& results, const std::string& group, const std::string& scenario, std::size_t iterations, Run&& run)
+    {
+        Silence silence;
+        std::vector<double> latencies(iterations);
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            run(i);
+            latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        for (const auto& [name, quantile] : {std::pair{"p50", 0.5}, std::pair{"p99", 0.99}, std::pair{"p99.9", 0.999}, std::pair{"max", 1.0}})
+        {
+            Result result;
+            result.group = group;
+            result.scenario = scenario + " " + name;
+            result.iterations = iterations;
+            result.nanoseconds = latencies[std::min(iterations - 1, static_cast<std::size_t>(quantile * static_cast<double>(iterations)))];
+            results.push_back(std::move(result));
+        }
+    }
+
+    /*
+     Окно из WINDOW живых объектов с текстом длиннее SSO: каждая операция заменяет один объект окна новым.
+     new/delete и std::make_unique выделяют память под объект и под строку, POOL::Pool возвращает объект с емкостью строки прошлого владельца.
+     */
+    template <class Slot, class Make>
+    struct Churn
+    {
+        static constexpr std::size_t WINDOW = 1024;
+
+        void operator()(std::size_t i)
+        {
+            Slot& slot = slots[i % WINDOW];
+            slot = make();
+            slot->_text.assign(text);
+        }
+
+        std::vector<Slot> slots = std::vector<Slot>(WINDOW);
+        Make make;
+        std::string text = std::string(64, 't');
+    };
+
+    template <class Slot, class Make>
+    void Churns(std::vector<Result>& results, const Options& options, const std::string& name, Make make)
+    {
+        using lvalue_rvalue::Derived;
+
+        const std::size_t elements = options.elements;
+        results.push_back(Process<Derived>("pool", name + " churn", elements, [elements, make]
+        {
+            Churn<Slot, Make> churn{.make = make};
+            for (std::size_t i = 0; i < elements; ++i)
+                churn(i);
+            DoNotOptimize(churn.slots.data());
+        }));
+
+        const std::size_t threads = options.threads;
+        Result parallel = Process<Derived>("pool", name + " churn " + std::to_string(threads) + " threads", elements * threads, [elements, threads, make]
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([elements, make]
+                {
+                    Churn<Slot, Make> churn{.make = make};
+                    for (std::size_t i = 0; i < elements; ++i)
+                        churn(i);
+                    DoNotOptimize(churn.slots.data());
+                });
+            }
+            for (std::thread& worker : workers)
+                worker.join();
+        });
+        parallel.threads = threads;
+        results.push_back(std::move(parallel));
+
+        Churn<Slot, Make> churn{.make = make};
+        Latency(results, "pool", name + " churn latency", options.iterations, churn);
+    }
+
+    /// Владеющий указатель new/delete, как до std::unique_ptr
+    struct Raw
+    {
+        Raw() noexcept = default;
+        Raw(lvalue_rvalue::Derived* derived) noexcept : _derived(derived) {}
+        Raw(Raw&& other) noexcept : _derived(std::exchange(other._derived, nullptr)) {}
+        Raw& operator=(Raw&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            delete std::exchange(_derived, std::exchange(other._derived, nullptr));
+            return *this;
+        }
+        ~Raw() { delete _derived; }
+
+        lvalue_rvalue::Derived* operator->() const noexcept { return _derived; }
+
+    private:
+        lvalue_rvalue::Derived* _derived = nullptr;
+    };
+
+    /*
+     Сценарии POOL: замена объектов в окне (churn) в одном и в options.threads потоках, задержка одной замены (p50 - max)
+     и передача между потоками через QUEUE::Ring: объекты возвращаются в кэш потока-потребителя и через общий список доходят до производителя.
+     allocations - выделений памяти на операцию, ops_per_sec_per_thread - операций в секунду.
+     */
+    void Pool(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+        using Handle = POOL::Handle<Derived>;
+
+        Churns<Raw>(results, options, "new Derived", [] { return Raw(new Derived()); });
+        Churns<std::unique_ptr<Derived>>(results, options, "std::make_unique<Derived>()", [] { return std::make_unique<Derived>(); });
+        Churns<Handle>(results, options, "POOL::Pool<Derived>::Acquire()", [] { return POOL::Pool<Derived>::Acquire(); });
+
+        const std::size_t items = options.elements;
+        const std::string text(64, 't');
+        results.push_back(Process<Derived>("pool", "QUEUE::Ring<std::unique_ptr<Derived>> 1P/1C", items, [items, &text]
+        {
+            Transfer<QUEUE::Ring<std::unique_ptr<Derived>>>(1, 1, items, [&text]
+            {
+                auto derived = std::make_unique<Derived>();
+                derived->_text.assign(text);
+                return derived;
+            });
+        }));
+        results.push_back(Process<Derived>("pool", "QUEUE::Ring<POOL::Handle<Derived>> 1P/1C", items, [items, &text]
+        {
+            Transfer<QUEUE::Ring<Handle>>(1, 1, items, [&text]
+            {
+                Handle derived = POOL::Pool<Derived>::Acquire();
+                derived->_text.assign(text);
+                return derived;
+            });
+        }));
+    }
+
+    void Consume(lvalue_rvalue::Derived derived)
+    {
+        DoNotOptimize(derived);
+    }
+
+    /*
+     Сценарии INVOKE: отложенный вызов Consume(Derived) с длинным _text через INVOKE::Task, std::function и std::bind.
+     Создание - перемещение аргумента в задачу (std::function не помещает Derived в свой буфер и выделяет память),
+     вызов - std::bind передает сохраненный аргумент как lvalue, поэтому параметр по значению копируется.
+     */
+    void Invoke(std::vector<Result>& results, const Options& options)
+    {
+        const std::size_t iterations = options.iterations;
+        using lvalue_rvalue::Derived;
+
+        const auto text = []
+        {
+            Derived derived;
+            derived.SetText(std::string(64, 't'));
+            return derived;
+        };
+
+        results.push_back(Measure<Derived>("invoke", "INVOKE::Defer(Consume, std::move(derived))", iterations, text,
+                                           [](Derived& derived) { auto task = INVOKE::Defer(Consume, std::move(derived)); DoNotOptimize(task); }));
+        results.push_back(Measure<Derived>("invoke", "std::function<void()>([derived = std::move(derived)])", iterations, text,
+                                           [](Derived& derived)
+                                           {
+                                               std::function<void()> function = [derived = std::move(derived)]() mutable { Consume(std::move(derived)); };
+                                               DoNotOptimize(function);
+                                           }));
+        results.push_back(Measure<Derived>("invoke", "std::bind(Consume, std::move(derived))", iterations, text,
+                                           [](Derived& derived) { auto bind = std::bind(Consume, std::move(derived)); DoNotOptimize(bind); }));
+
+        results.push_back(Measure<Derived>("invoke", "std::move(task)()", iterations,
+                                           [&text] { return INVOKE::Defer(Consume, text()); },
+                                           [](auto& task) { std::move(task)(); }));
+        results.push_back(Measure<Derived>("invoke", "function()", iterations,
+                                           [&text] { return std::function<void()>([derived = text()]() mutable { Consume(std::move(derived)); }); },
+                                           [](std::function<void()>& function) { function(); }));
+        results.push_back(Measure<Derived>("invoke", "bind()", iterations,
+                                           [&text] { return std::bind(Consume, text()); },
+                                           [](auto& bind) { bind(); }));
+
+        /// Маленький аргумент: все три помещаются в свой буфер
+        results.push_back(Measure<>("invoke", "INVOKE::Defer(function, number)()", iterations, [] { return 1; },
+                                    [](int& number) { INVOKE::Defer([](int value) { DoNotOptimize(value); }, number)(); }));
+        results.push_back(Measure<>("invoke", "std::function<void()>([number])()", iterations, [] { return 1; },
+                                    [](int& number) { std::function<void()>([number] { DoNotOptimize(number); })(); }));
+        results.push_back(Measure<>("invoke", "std::bind(function, number)()", iterations, [] { return 1; },
+                                    [](int& number) { std::bind([](int value) { DoNotOptimize(value); }, number)(); }));
+    }
+
+    /// Поток Derived неизвестной длины: итератор только перемещается, элементы - prvalue, размер заранее не известен
+    class Stream
+    {
+    public:
+        class iterator
+        {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = lvalue_rvalue::Derived;
+
+            explicit iterator(std::size_t remaining, const std::string* text) :
+            _remaining(remaining),
+            _text(text)
+            {}
+
+            iterator(iterator&&) = default;
+            iterator& operator=(iterator&&) = default;
+
+            value_type operator*() const
+            {
+                value_type derived;
+                derived.SetText(*_text);
+                return derived;
+            }
+
+            iterator& operator++() { --_remaining; return *this; }
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept { return !it._remaining; }
+
+        private:
+            std::size_t _remaining;
+            const std::string* _text;
+        };
+
+        Stream(std::size_t count, const std::string& text) :
+        _count(count),
+        _text(&text)
+        {}
+
+        iterator begin() const { return iterator(_count, _text); }
+        std::default_sentinel_t end() const noexcept { return {}; }
+
+    private:
+        std::size_t _count;
+        const std::string* _text;
+    };
+
+    /*
+     Сценарии INGEST: загрузка options.elements объектов Derived с длинным _text (для 10^7: --elements 10000000) в пустой std::vector.
+     Источник создается до замера. Цикл emplace_back без reserve - для сравнения: рост переносит элементы несколько раз.
+     */
+    void Ingest(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+        const std::size_t elements = options.elements;
+        const std::string text(64, 't');
+
+        struct State
+        {
+            std::vector<Derived> source;
+            std::vector<Derived> target;
+        };
+
+        const auto source = [elements, &text]
+        {
+            State state;
+            INGEST::Append(state.source, Stream(elements, text), elements);
+            return state;
+        };
+        const auto empty = [] { return State(); };
+
+        results.push_back(Process<Derived>("ingest", "emplace_back(derived) loop from std::vector& grow", elements, source, [](State& state)
+        {
+            for (const Derived& derived : state.source)
+                state.target.emplace_back(derived);
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "INGEST::Append(target, source) copy", elements, source, [](State& state)
+        {
+            INGEST::Append(state.target, state.source);
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "INGEST::Append(target, std::move(source))", elements, source, [](State& state)
+        {
+            INGEST::Append(state.target, std::move(state.source));
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "INGEST::Append(target, std::move_iterator range)", elements, source, [](State& state)
+        {
+            INGEST::Append(state.target, std::ranges::subrange(std::make_move_iterator(state.source.begin()), std::make_move_iterator(state.source.end())));
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "INGEST::Append(target, generator)", elements, empty, [elements, &text](State& state)
+        {
+            const auto generate = [&text](std::size_t)
+            {
+                Derived derived;
+                derived.SetText(text);
+                return derived;
+            };
+            INGEST::Append(state.target, std::views::iota(std::size_t{0}, elements) | std::views::transform(generate));
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "INGEST::Append(target, stream, expected)", elements, empty, [elements, &text](State& state)
+        {
+            INGEST::Append(state.target, Stream(elements, text), elements);
+            DoNotOptimize(state.target.data());
+        }));
+        results.push_back(Process<Derived>("ingest", "emplace_back(*it) loop from stream grow", elements, empty, [elements, &text](State& state)
+        {
+            Stream stream(elements, text);
+            for (auto it = stream.begin(); it != stream.end(); ++it)
+                state.target.emplace_back(*it);
+            DoNotOptimize(state.target.data());
+        }));
+    }
+
+    /// Перегрузка priority::function, выполненная при замере, не совпала с priority::Expected - бенчмарк завершается с ошибкой (проверка в ctest)
+    bool bindingMismatch = false;
+
+    /*
+     Политика priority::function для замера: аргумент сохраняется в локальный объект с категорией выбранной перегрузки.
+     && - перемещение, const && - копирование (const объект не перемещается), & и const & - копирование.
+     bound - название перегрузки, выполненной последней.
+     */
+    struct Sink
+    {
+        template<class Bound, class Value>
+        static void Bind(Value&& value)
+        {
+            std::remove_cvref_t<Value> stored(std::forward<Value>(value));
+            DoNotOptimize(stored);
+            bound = lvalue_rvalue::priority::Name(Bound{});
+        }
+
+        static inline std::string_view bound;
+    };
+
+    /*
+     Одна строка таблицы перегрузки: аргумент - выражение static_cast<Expression>(payload).
+     - Silent, Sink - встроенный вызов: Silent - только выбор перегрузки (0 нс, если встроен), Sink - выбор и сохранение аргумента;
+     - Silent call, Sink call - вызов через volatile указатель: копия перегрузки вне места вызова, code_bytes - ее размер.
+     */
+    template<class Expression, class Setup>
+    void Dispatch(std::vector<Result>& results, std::size_t iterations, const std::string& name, Setup& setup)
+    {
+        using namespace lvalue_rvalue::priority;
+        using lvalue_rvalue::Derived;
+        using Payload = std::remove_cvref_t<Expression>;
+        using Bound = typename Expected<Expression>::type;
+
+        const std::string scenario = name + " -> " + Name(Expected<Expression>{});
+        Binding<Bound> (*volatile silent)(Bound) = &function<Silent, Payload>;
+        Binding<Bound> (*volatile sink)(Bound) = &function<Sink, Payload>;
+
+        results.push_back(Measure<Derived>("priority", scenario + " Silent", iterations, setup,
+                                           [](Payload& payload) { DoNotOptimize(function<Silent>(static_cast<Expression>(payload))); }));
+        Sink::bound = {};
+        results.push_back(Measure<Derived>("priority", scenario + " Sink", iterations, setup,
+                                           [](Payload& payload) { function<Sink>(static_cast<Expression>(payload)); }));
+        if (Sink::bound != Name(Expected<Expression>{}))
+        {
+            std::cerr << "priority::function: " << name << " bound to " << Sink::bound << ", expected " << Name(Expected<Expression>{}) << '\n';
+            bindingMismatch = true;
+        }
+
+        results.push_back(Measure<Derived>("priority", scenario + " Silent call", iterations, setup,
+                                           [&silent](Payload& payload) { silent(static_cast<Expression>(payload)); }));
+        results.back().codeBytes = CodeSize(reinterpret_cast<const void*>(silent));
+        results.push_back(Measure<Derived>("priority", scenario + " Sink call", iterations, setup,
+                                           [&sink](Payload& payload) { sink(static_cast<Expression>(payload)); }));
+        results.back().codeBytes = CodeSize(reinterpret_cast<const void*>(sink));
+    }
+
+    template<class Payload, class Setup>
+    void Dispatches(std::vector<Result>& results, std::size_t iterations, const std::string& name, Setup setup)
+    {
+        Dispatch<Payload&&>(results, iterations, name + " xvalue", setup);
+        Dispatch<const Payload&&>(results, iterations, name + " const xvalue", setup);
+        Dispatch<Payload&>(results, iterations, name + " lvalue", setup);
+        Dispatch<const Payload&>(results, iterations, name + " const lvalue", setup);
+    }
+
+    /*
+     Сценарии priority: стоимость каждой перегрузки priority::function для каждого типа аргумента.
+     Копирование, которого избегает &&, видно по copies (Derived) и allocations (std::string, std::vector длиннее SSO),
+     встраивание - по разнице Silent и Silent call, размер кода - по code_bytes.
+     Таблица ожидаемых перегрузок проверяется при компиляции (priority::Check), выполненная перегрузка - при замере Sink.
+     */
+    void Priority(std::vector<Result>& results, const Options& options)
+    {
+        using lvalue_rvalue::Derived;
+        static_assert(lvalue_rvalue::priority::Check<COW::Derived, PAYLOAD::InlineString<16>>());
+
+        Dispatches<int>(results, options.iterations, "int", [] { return 7; });
+        Dispatches<std::string>(results, options.iterations, "std::string", [] { return std::string(64, 't'); });
+        Dispatches<Derived>(results, options.iterations, "Derived", []
+        {
+            Derived derived;
+            derived._text = std::string(64, 't');
+            return derived;
+        });
+        Dispatches<std::vector<int>>(results, options.iterations, "std::vector<int>", [] { return std::vector<int>(64, 7); });
+    }
+
+    template <class... Types, class Function>
+    void Expect(std::vector<Result>& results, const std::string& name, BUDGET::Budget budget, Function&& function, const char* group = "budget")
+    {
+        const BUDGET::Report report = BUDGET::Expect<Types...>(name, budget, std::forward<Function>(function));
+        Verify(report);
+
+        Result result;
+        result.group = group;
+        result.scenario = name;
+        result.iterations = 1;
+        result.events = report.events;
+        results.push_back(std::move(result));
+    }
+
+    /*
+     Сценарии BUDGET: пути без копирования закреплены бюджетом, лишнее копирование - ошибка бенчмарка, а не строка в выводе.
+     FORWARD::A перемещается без noexcept, поэтому рост std::vector<A> копирует элементы (std::move_if_noexcept), Derived - перемещает.
+     */
+    void Budget(std::vector<Result>& results, const Options&)
+    {
+        using namespace FORWARD;
+        using lvalue_rvalue::Derived;
+
+        static_assert(BUDGET::NothrowMovable<Derived> && BUDGET::VectorGrowsByMove<Derived>);
+        static_assert(!BUDGET::VectorGrowsByMove<A>);
+        static_assert(BUDGET::SwapWithoutMoves<std::string> && !BUDGET::SwapWithoutMoves<Derived>);
+        static_assert(BUDGET::BitwiseCopyable<PAYLOAD::InlineString<16>>);
+
+        Expect<A>(results, "Make_Shared_Forward<A>(A())", {.copies = 0, .moves = 1},
+                  [] { auto pointer = Make_Shared_Forward<A>(A()); DoNotOptimize(pointer); });
+        Expect<A>(results, "Make_Shared_Forward<A>(std::move(a))", {.copies = 0, .moves = 1},
+                  [] { A a; auto pointer = Make_Shared_Forward<A>(std::move(a)); DoNotOptimize(pointer); });
+        Expect<A>(results, "Make_Shared_Forward<std::pair<A, A>>(A(), A())", {.copies = 0, .moves = 2},
+                  [] { auto pointer = Make_Shared_Forward<std::pair<A, A>>(A(), A()); DoNotOptimize(pointer); });
+        Expect<Derived>(results, "SWAP::swap(Derived, Derived)", {.copies = 0, .moves = 3},
+                        []
+                        {
+                            Derived first, second;
+                            second.SetText(std::string(64, 't'));
+                            SWAP::swap(first, second);
+                            DoNotOptimize(first);
+                        });
+        Expect<Derived>(results, "deriveds.emplace_back(std::move(derived)) reserve", {.copies = 0, .moves = 1},
+                        []
+                        {
+                            std::vector<Derived> deriveds;
+                            deriveds.reserve(1);
+                            Derived derived;
+                            deriveds.emplace_back(std::move(derived));
+                            DoNotOptimize(deriveds);
+                        });
+        Expect<Derived>(results, "deriveds.emplace_back() x8 grow", {.copies = 0, .moves = 7},
+                        []
+                        {
+                            std::vector<Derived> deriveds;
+                            for (int i = 0; i < 8; ++i)
+                                deriveds.emplace_back();
+                            DoNotOptimize(deriveds);
+                        });
+    }
+
+    /// Одна форма ELISION: фактические копирования и перемещения в строке отчета, больше ожидаемого - ошибка бенчмарка
+    template <class Function>
+    void Elided(std::vector<Result>& results, const std::string& name, BUDGET::Budget budget, Function&& function)
+    {
+        Expect<lvalue_rvalue::Derived>(results, name, budget, std::forward<Function>(function), "elision");
+    }
+
+    /*
+     Пропуск копирования (elision.h): Expected(с NRVO, с -fno-elide-constructors) - точные числа gcc 12 при -O0, -O2 и -O3,
+     от оптимизации они не зависят - пропуск решает компилятор до оптимизатора. Scoped: clang применяет NRVO и к объектам
+     в непересекающихся областях (0 перемещений), gcc - нет, бюджет - худший из допустимых стандартом вариантов.
+     */
+    void Elision(std::vector<Result>& results, const Options&)
+    {
+        using namespace ELISION;
+        using lvalue_rvalue::getDerived1;
+        using lvalue_rvalue::getDerived2;
+        using lvalue_rvalue::getDerived3;
+
+        Elided(results, "Derived derived = getDerived1()", Expected({.copies = 0, .moves = 0}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = getDerived1(); DoNotOptimize(derived); });
+        Elided(results, "Derived derived = getDerived2()", Expected({.copies = 0, .moves = 0}, {.copies = 0, .moves = 0}),
+               [] { Derived derived = getDerived2(); DoNotOptimize(derived); });
+        Elided(results, "Derived derived = getDerived3()", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = getDerived3(); DoNotOptimize(derived); });
+        Elided(results, "const Derived& derived = getDerived1()", Expected({.copies = 0, .moves = 0}, {.copies = 0, .moves = 1}),
+               [] { const Derived& derived = getDerived1(); DoNotOptimize(derived); });
+        Elided(results, "derived = getDerived2()", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived; derived = getDerived2(); DoNotOptimize(derived); });
+        Elided(results, "NRVO: if (flag) return derived; return derived;", Expected({.copies = 0, .moves = 0}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = NamedBranches(true); DoNotOptimize(derived); });
+        Elided(results, "if (flag) return first; return second;", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = Either(true); DoNotOptimize(derived); });
+        Elided(results, "return flag ? first : second;", Expected({.copies = 1, .moves = 0}, {.copies = 1, .moves = 0}),
+               [] { Derived derived = Ternary(true); DoNotOptimize(derived); });
+        Elided(results, "{ Derived first; return first; } return second;", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = Scoped(true); DoNotOptimize(derived); });
+        Elided(results, "return pair.first;", Expected({.copies = 1, .moves = 0}, {.copies = 1, .moves = 0}),
+               [] { Derived derived = Member(); DoNotOptimize(derived); });
+        Elided(results, "return std::move(pair.first);", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = MovedMember(); DoNotOptimize(derived); });
+        Elided(results, "Parameter(Derived()): return derived;", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = Parameter(Derived()); DoNotOptimize(derived); });
+        Elided(results, "return std::move(derived);", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { Derived derived = Moved(); DoNotOptimize(derived); });
+        Elided(results, "const Derived derived; return derived;", Expected({.copies = 0, .moves = 0}, {.copies = 1, .moves = 0}),
+               [] { Derived derived = Constant(); DoNotOptimize(derived); });
+        Elided(results, "std::optional<Derived>: return derived;", Expected({.copies = 0, .moves = 1}, {.copies = 0, .moves = 1}),
+               [] { std::optional<Derived> derived = Converted(); DoNotOptimize(derived); });
+    }
+
+    using Group = std::function<void(std::vector<Result>&, const Options&)>;
+
+    const std::map<std::string, Group>& Groups()
+    {
+        static const std::map<std::string, Group> groups =
+        {
+            {"lvalue_rvalue", LvalueRvalue},
+            {"priority", Priority},
+            {"swap", Swap},
+            {"forward", Forward},
+            {"payload", Payload},
+            {"pmr", Pmr},
+            {"relocate", Relocate},
+            {"collector", Collector},
+            {"workload", Workload},
+            {"queue", Queue},
+            {"budget", Budget},
+            {"elision", Elision},
+            {"invoke", Invoke},
+            {"ingest", Ingest},
+            {"cow", Cow},
+            {"soa", Soa},
+            {"serialize", Serialize},
+            {"pool", Pool},
+            {"generator", Generator},
+        };
+        return groups;
+    }
+
+    int Usage(const char* program)
+    {
+        std::cerr << "Usage: " << program << " [--format csv|json|table] [--iterations N] [--elements N] [--threads N] [--output FILE] [GROUP...]\n"
+                  << "Groups:";
+        for (const auto& [name, group] : Groups())
+            std::cerr << ' ' << name;
+        std::cerr << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const auto& groups = Groups();
+
+    Format format = Format::CSV;
+    Options options;
+    std::string output;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--format" && i + 1 < argc)
+        {
+            const std::string value = argv[++i];
+            if (value == "csv")
+                format = Format::CSV;
+            else if (value == "json")
+                format = Format::JSON;
+            else if (value == "table")
+                format = Format::Table;
+            else
+                return Usage(argv[0]);
+        }
+        else if (argument == "--iterations" && i + 1 < argc)
+            options.iterations = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--elements" && i + 1 < argc)
+            options.elements = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--threads" && i + 1 < argc)
+            options.threads = std::strtoull(argv[++i], nullptr, 10);
+        else if (argument == "--output" && i + 1 < argc)
+            output = argv[++i];
+        else if (groups.count(argument))
+            selected.push_back(argument);
+        else
+            return Usage(argv[0]);
+    }
+
+    if (options.iterations == 0 || options.elements == 0 || options.threads == 0)
+        return Usage(argv[0]);
+
+    std::vector<Result> results;
+    for (const auto& [name, group] : groups)
+    {
+        if (selected.empty() || std::find(selected.begin(), selected.end(), name) != selected.end())
+            group(results, options);
+    }
+
+    if (output.empty())
+    {
+        Write(std::cout, results, format);
+    }
+    else
+    {
+        std::ofstream file(output);
+        if (!file)
+        {
+            std::cerr << "Cannot open " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+        Write(file, results, format);
+    }
+
+    return budgetExceeded || bindingMismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,566 @@
+#ifndef benchmark_h
+#define benchmark_h
+
+#include "allocation.h"
+#include "counter.h"
+#include "perf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <elf.h>
+#include <link.h>
+#endif
+
+/*
+ Бенчмарк - замер времени и числа копирований/перемещений/выделений памяти на одну операцию.
+ Каждый сценарий состоит из двух частей:
+ 1. setup - подготовка состояния (не замеряется и не считается), например, вектор с reserve(1) и объект для emplace_back.
+ 2. run - замеряемая операция над подготовленным состоянием.
+ Сценарии с большим числом объектов запускаются через Process() в отдельном процессе (fork), чтобы пиковая память (peak RSS) одного сценария не влияла на другие.
+ Результат выводится в машиночитаемом виде (CSV или JSON), чтобы регрессия в обработке lvalue/rvalue была видна по числам, а не по изменению текста в консоли.
+ Format::Table - та же информация по сценариям для чтения, вместе со счетчиками процессора (perf.h), компилятором и флагами сборки.
+ Использование:
+ auto result = BENCHMARK::Measure<Derived>("lvalue_rvalue", "getDerived1", 100000,
+                                           [] { return 0; },
+                                           [](int&) { Derived derived = getDerived1(); });
+ */
+namespace BENCHMARK
+{
+    struct Allocations
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+
+        friend Allocations operator-(Allocations lhs, const Allocations& rhs) noexcept
+        {
+            lhs.count -= rhs.count;
+            lhs.bytes -= rhs.bytes;
+            return lhs;
+        }
+    };
+
+    /// Выделения памяти всех потоков, считает ALLOCATION (operator new заменен в benchmark.cpp)
+    inline Allocations Allocated() noexcept
+    {
+        const ALLOCATION::Statistics total = ALLOCATION::Total();
+        return {total.count, total.bytes};
+    }
+
+    /// Не дает компилятору выбросить вычисление, результат которого не используется
+    template <class T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    /// Глушит std::cout на время замера, чтобы консольный вывод (например, priority::function) не попадал в отчет
+    class Silence
+    {
+        class NullBuffer : public std::streambuf
+        {
+        protected:
+            int overflow(int c) override { return traits_type::not_eof(c); }
+            std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+        };
+
+    public:
+        Silence() : _buffer(std::cout.rdbuf(&_null)) {}
+        ~Silence() { std::cout.rdbuf(_buffer); }
+        Silence(const Silence&) = delete;
+        Silence& operator=(const Silence&) = delete;
+
+    private:
+        NullBuffer _null;
+        std::streambuf* _buffer;
+    };
+
+    struct Result
+    {
+        std::string group;
+        std::string scenario;
+        std::size_t iterations = 0;
+        double nanoseconds = 0.0; // На одну операцию
+        COUNTER::Snapshot events; // Сумма по всем итерациям
+        Allocations allocations;  // Сумма по всем итерациям
+        std::size_t peakRss = 0;  // Прирост пиковой памяти процесса в КБ, только для Process()
+        std::size_t threads = 1;  // Потоков в сценарии, для пропускной способности на поток
+        PERF::Sample perf;        // Сумма по всем итерациям, perf.Valid(event) == false - счетчик недоступен
+        std::size_t codeBytes = 0; // Размер функции сценария в байтах (CodeSize), 0 - не замерялся
+    };
+
+    template <class... Types>
+    COUNTER::Snapshot Events()
+    {
+        COUNTER::Snapshot snapshot;
+        ((snapshot += COUNTER::Counter<Types>::Get()), ...);
+        return snapshot;
+    }
+
+    /// Types - типы, чьи счетчики COUNTER::Counter попадают в отчет
+    template <class... Types, class Setup, class Run>
+    Result Measure(const std::string& group, const std::string& scenario, std::size_t iterations, Setup&& setup, Run&& run)
+    {
+        using State = decltype(setup());
+
+        Silence silence;
+        std::vector<State> states;
+        states.reserve(iterations);
+        for (std::size_t i = 0; i < iterations; ++i)
+            states.emplace_back(setup());
+
+        Result result;
+        result.group = group;
+        result.scenario = scenario;
+        result.iterations = iterations;
+
+        PERF::Counters counters;
+        const COUNTER::Snapshot events = Events<Types...>();
+        const Allocations before = Allocated();
+        counters.Start();
+        const auto start = std::chrono::steady_clock::now();
+        for (auto& state : states)
+        {
+            run(state);
+            DoNotOptimize(state);
+        }
+        const auto finish = std::chrono::steady_clock::now();
+        result.perf = counters.Stop();
+        result.allocations = Allocated() - before;
+        result.events = Events<Types...>() - events;
+        result.nanoseconds = std::chrono::duration<double, std::nano>(finish - start).count() / static_cast<double>(iterations ? iterations : 1);
+        return result;
+    }
+
+    namespace detail
+    {
+        /// Пиковая память процесса в КБ
+        inline std::size_t PeakRss()
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+            return static_cast<std::size_t>(usage.ru_maxrss) / 1024; // macOS - в байтах
+#else
+            return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#else
+            return 0;
+#endif
+        }
+
+        /// Замер одного запуска, передается из дочернего процесса через pipe
+        struct Sample
+        {
+            double nanoseconds = 0.0;
+            COUNTER::Snapshot events;
+            Allocations allocations;
+            std::size_t peakRss = 0;
+            PERF::Sample perf;
+        };
+
+        template <class... Types, class Setup, class Function>
+        Sample Run(Setup& setup, Function& run)
+        {
+            Sample sample;
+            auto state = setup();
+            const std::size_t rss = PeakRss();
+            PERF::Counters counters;
+            const COUNTER::Snapshot events = Events<Types...>();
+            const Allocations before = Allocated();
+            counters.Start();
+            const auto start = std::chrono::steady_clock::now();
+            run(state);
+            const auto finish = std::chrono::steady_clock::now();
+            sample.perf = counters.Stop();
+            sample.allocations = Allocated() - before;
+            sample.events = Events<Types...>() - events;
+            sample.nanoseconds = std::chrono::duration<double, std::nano>(finish - start).count();
+            sample.peakRss = PeakRss() - rss;
+            return sample;
+        }
+    }
+
+    /*
+     run(state) выполняется один раз в отдельном процессе, iterations - число элементов, на которое делятся результаты.
+     state = setup() создается в том же процессе до замера (например, исходный вектор), пиковая память считается после setup.
+     */
+    template <class... Types, class Setup, class Run>
+    Result Process(const std::string& group, const std::string& scenario, std::size_t iterations, Setup&& setup, Run&& run)
+    {
+        Silence silence;
+        detail::Sample sample;
+#if defined(__unix__) || defined(__APPLE__)
+        int channel[2];
+        if (pipe(channel) == 0)
+        {
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                close(channel[0]);
+                const detail::Sample child = detail::Run<Types...>(setup, run);
+                [[maybe_unused]] const auto written = write(channel[1], &child, sizeof(child));
+                _exit(EXIT_SUCCESS);
+            }
+
+            close(channel[1]);
+            if (pid > 0)
+            {
+                if (read(channel[0], &sample, sizeof(sample)) != static_cast<ssize_t>(sizeof(sample)))
+                    sample = detail::Sample();
+                waitpid(pid, nullptr, 0);
+            }
+            close(channel[0]);
+        }
+#else
+        sample = detail::Run<Types...>(setup, run);
+#endif
+        Result result;
+        result.group = group;
+        result.scenario = scenario;
+        result.iterations = iterations;
+        result.nanoseconds = sample.nanoseconds / static_cast<double>(iterations ? iterations : 1);
+        result.events = sample.events;
+        result.allocations = sample.allocations;
+        result.peakRss = sample.peakRss;
+        result.perf = sample.perf;
+        return result;
+    }
+
+    /// run() выполняется один раз в отдельном процессе, iterations - число элементов, на которое делятся результаты
+    template <class... Types, class Run>
+    Result Process(const std::string& group, const std::string& scenario, std::size_t iterations, Run&& run)
+    {
+        return Process<Types...>(group, scenario, iterations, [] { return 0; }, [&run](int&) { run(); });
+    }
+
+    namespace detail
+    {
+        /// Функция исполняемого файла: адрес относительно начала загрузки и размер в байтах
+        struct Symbol
+        {
+            std::uintptr_t address = 0;
+            std::size_t size = 0;
+
+            friend bool operator<(const Symbol& lhs, const Symbol& rhs) noexcept { return lhs.address < rhs.address; }
+        };
+
+        /// Функции из таблицы символов (.symtab) /proc/self/exe, читается один раз, пусто - таблица удалена (strip) или не Linux
+        inline const std::vector<Symbol>& Symbols()
+        {
+            static const std::vector<Symbol> symbols = []
+            {
+                std::vector<Symbol> symbols;
+#if defined(__linux__) && defined(__LP64__)
+                std::ifstream file("/proc/self/exe", std::ios::binary);
+                const std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                if (image.size() < sizeof(Elf64_Ehdr) || std::memcmp(image.data(), ELFMAG, SELFMAG) != 0)
+                    return symbols;
+
+                Elf64_Ehdr header;
+                std::memcpy(&header, image.data(), sizeof(header));
+                for (std::size_t i = 0; i < header.e_shnum; ++i)
+                {
+                    Elf64_Shdr section;
+                    const std::size_t offset = header.e_shoff + i * sizeof(Elf64_Shdr);
+                    if (offset + sizeof(section) > image.size())
+                        break;
+                    std::memcpy(&section, image.data() + offset, sizeof(section));
+                    if (section.sh_type != SHT_SYMTAB || section.sh_offset + section.sh_size > image.size())
+                        continue;
+
+                    for (std::size_t j = 0; j < section.sh_size / sizeof(Elf64_Sym); ++j)
+                    {
+                        Elf64_Sym symbol;
+                        std::memcpy(&symbol, image.data() + section.sh_offset + j * sizeof(Elf64_Sym), sizeof(symbol));
+                        if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC && symbol.st_size)
+                            symbols.push_back({symbol.st_value, symbol.st_size});
+                    }
+                }
+                std::sort(symbols.begin(), symbols.end());
+#endif
+                return symbols;
+            }();
+            return symbols;
+        }
+    }
+
+    /*
+     Размер машинного кода функции по ее адресу, 0 - символ не найден.
+     Функция, встроенная во все места вызова, не имеет своего символа: размер считается для копии, на которую взят адрес.
+     auto pointer = &priority::function<priority::Silent, int>; // Копия вне места вызова
+     CodeSize(reinterpret_cast<const void*>(pointer));
+     */
+    inline std::size_t CodeSize(const void* function)
+    {
+#if defined(__linux__)
+        std::uintptr_t base = 0; // Начало загрузки исполняемого файла (PIE), первый объект dl_iterate_phdr
+        dl_iterate_phdr([](dl_phdr_info* info, std::size_t, void* data)
+                        {
+                            *static_cast<std::uintptr_t*>(data) = info->dlpi_addr;
+                            return 1;
+                        }, &base);
+
+        const auto& symbols = detail::Symbols();
+        const detail::Symbol key{reinterpret_cast<std::uintptr_t>(function) - base};
+        const auto it = std::lower_bound(symbols.begin(), symbols.end(), key);
+        if (it != symbols.end() && it->address == key.address)
+            return it->size;
+#endif
+        return 0;
+    }
+
+    enum class Format
+    {
+        CSV,
+        JSON,
+        Table // Таблица для чтения: время, процессорное время, копирования, перемещения и счетчики PERF на операцию по сценариям
+    };
+
+    namespace detail
+    {
+        inline double PerOperation(std::size_t value, std::size_t iterations)
+        {
+            return iterations ? static_cast<double>(value) / static_cast<double>(iterations) : 0.0;
+        }
+
+        inline std::string Escape(const std::string& text)
+        {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (char symbol : text)
+            {
+                if (symbol == '"' || symbol == '\\')
+                    escaped += '\\';
+                escaped += symbol;
+            }
+            return escaped;
+        }
+
+        /// Операций в секунду на один поток
+        inline double Throughput(const Result& result)
+        {
+            return result.nanoseconds > 0.0 ? 1e9 / result.nanoseconds / static_cast<double>(result.threads ? result.threads : 1) : 0.0;
+        }
+
+        inline std::string Key(PERF::Event event)
+        {
+            return PERF::Name(event);
+        }
+
+        /// Компилятор и версия, чтобы сравнивать отчеты разных сборок
+        inline std::string Compiler()
+        {
+#if defined(__clang__)
+            return "clang " __clang_version__;
+#elif defined(__GNUC__)
+            return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        /// Флаги сборки: LVALUE_RVALUE_BUILD задает CMake (оптимизация, LTO, PGO, санитайзер), иначе только признак оптимизации
+        inline std::string Build()
+        {
+#if defined(LVALUE_RVALUE_BUILD)
+            return LVALUE_RVALUE_BUILD;
+#elif defined(__OPTIMIZE__)
+            return "optimized";
+#else
+            return "debug";
+#endif
+        }
+
+        /// Процессорное время всех потоков на одну операцию (clock_gettime), есть и без счетчиков PERF
+        inline double CpuTime(const Result& result)
+        {
+            return detail::PerOperation(result.perf.cpuNanoseconds, result.iterations);
+        }
+
+        inline std::string Key(COUNTER::Event event)
+        {
+            std::string key = COUNTER::Name(event);
+            for (auto& symbol : key)
+            {
+                if (symbol == ' ')
+                    symbol = '_';
+            }
+            if (key.back() == '=')
+                key.replace(key.size() - std::string("operator=").size(), std::string::npos, "assignment");
+            return key;
+        }
+    }
+
+    namespace detail
+    {
+        /*
+         Таблица по группам: время и процессорное время (clock_gettime), копирования и перемещения на операцию есть всегда,
+         счетчики PERF на операцию и инструкции за такт (IPC) - если доступны, иначе "-", размер кода функции сценария - если замерялся.
+         В заголовке компилятор и флаги сборки, чтобы таблицы разных сборок можно было положить рядом.
+         */
+        inline void WriteTable(std::ostream& stream, const std::vector<Result>& results)
+        {
+            using PERF::Event;
+
+            const auto cell = [&stream](const Result& result, Event event)
+            {
+                stream << ' ' << std::setw(12);
+                if (result.perf.Valid(event))
+                    stream << PerOperation(result.perf[event], result.iterations);
+                else
+                    stream << '-';
+            };
+
+            const std::ios_base::fmtflags flags = stream.flags();
+            const std::streamsize precision = stream.precision();
+            stream << std::fixed << std::setprecision(2)
+                   << "# " << Compiler() << ", " << Build() << '\n';
+
+            std::string group;
+            for (const auto& result : results)
+            {
+                if (result.group != group)
+                {
+                    group = result.group;
+                    stream << '\n' << group << '\n' << std::left << std::setw(64) << "scenario" << std::right;
+                    for (const char* column : {"ns/op", "cpu ns/op", "copies/op", "moves/op", "IPC"})
+                        stream << ' ' << std::setw(12) << column;
+                    for (std::size_t i = 0; i < PERF::EVENTS; ++i)
+                        stream << ' ' << std::setw(12) << PERF::Name(static_cast<Event>(i));
+                    stream << ' ' << std::setw(12) << "code bytes" << '\n';
+                }
+
+                stream << std::left << std::setw(64) << result.scenario << std::right
+                       << ' ' << std::setw(12) << result.nanoseconds
+                       << ' ' << std::setw(12) << CpuTime(result)
+                       << ' ' << std::setw(12) << PerOperation(result.events.Copies(), result.iterations)
+                       << ' ' << std::setw(12) << PerOperation(result.events.Moves(), result.iterations)
+                       << ' ' << std::setw(12);
+                if (result.perf.Valid(Event::Cycles) && result.perf.Valid(Event::Instructions) && result.perf[Event::Cycles])
+                    stream << static_cast<double>(result.perf[Event::Instructions]) / static_cast<double>(result.perf[Event::Cycles]);
+                else
+                    stream << '-';
+                for (std::size_t i = 0; i < PERF::EVENTS; ++i)
+                    cell(result, static_cast<Event>(i));
+                stream << ' ' << std::setw(12);
+                if (result.codeBytes)
+                    stream << result.codeBytes;
+                else
+                    stream << '-';
+                stream << '\n';
+            }
+            stream.flags(flags);
+            stream.precision(precision);
+        }
+    }
+
+    /// Все значения, кроме iterations, peak_rss_kb, threads, ops_per_sec_per_thread и code_bytes, приведены к одной операции, недоступные счетчики PERF - пустые (null)
+    inline void Write(std::ostream& stream, const std::vector<Result>& results, Format format)
+    {
+        using namespace COUNTER;
+
+        if (format == Format::CSV)
+        {
+            stream << "group,scenario,iterations,ns_per_op";
+            for (std::size_t i = 0; i < EVENTS; ++i)
+                stream << ',' << detail::Key(static_cast<Event>(i));
+            stream << ",copies,moves,allocations,bytes,peak_rss_kb,threads,ops_per_sec_per_thread,cpu_ns_per_op";
+            for (std::size_t i = 0; i < PERF::EVENTS; ++i)
+                stream << ',' << detail::Key(static_cast<PERF::Event>(i));
+            stream << ",code_bytes,compiler,build\n";
+
+            const std::string context = ",\"" + detail::Escape(detail::Compiler()) + "\",\"" + detail::Escape(detail::Build()) + '"';
+
+            for (const auto& result : results)
+            {
+                stream << result.group << ",\"" << detail::Escape(result.scenario) << "\"," << result.iterations << ',' << result.nanoseconds;
+                for (std::size_t i = 0; i < EVENTS; ++i)
+                    stream << ',' << detail::PerOperation(result.events[static_cast<Event>(i)], result.iterations);
+                stream << ',' << detail::PerOperation(result.events.Copies(), result.iterations)
+                       << ',' << detail::PerOperation(result.events.Moves(), result.iterations)
+                       << ',' << detail::PerOperation(result.allocations.count, result.iterations)
+                       << ',' << detail::PerOperation(result.allocations.bytes, result.iterations)
+                       << ',' << result.peakRss
+                       << ',' << result.threads
+                       << ',' << detail::Throughput(result)
+                       << ',' << detail::CpuTime(result);
+                for (std::size_t i = 0; i < PERF::EVENTS; ++i)
+                {
+                    stream << ',';
+                    if (result.perf.Valid(static_cast<PERF::Event>(i)))
+                        stream << detail::PerOperation(result.perf[static_cast<PERF::Event>(i)], result.iterations);
+                }
+                stream << ',' << result.codeBytes << context << '\n';
+            }
+            return;
+        }
+
+        if (format == Format::Table)
+        {
+            detail::WriteTable(stream, results);
+            return;
+        }
+
+        stream << "{\n  \"context\": {\"compiler\": \"" << detail::Escape(detail::Compiler())
+               << "\", \"build\": \"" << detail::Escape(detail::Build()) << "\"},\n  \"benchmarks\": [";
+        for (std::size_t r = 0; r < results.size(); ++r)
+        {
+            const auto& result = results[r];
+            stream << (r ? ",\n" : "\n") << "    {\"group\": \"" << detail::Escape(result.group)
+                   << "\", \"scenario\": \"" << detail::Escape(result.scenario)
+                   << "\", \"iterations\": " << result.iterations
+                   << ", \"ns_per_op\": " << result.nanoseconds;
+            for (std::size_t i = 0; i < EVENTS; ++i)
+                stream << ", \"" << detail::Key(static_cast<Event>(i)) << "\": " << detail::PerOperation(result.events[static_cast<Event>(i)], result.iterations);
+            stream << ", \"copies\": " << detail::PerOperation(result.events.Copies(), result.iterations)
+                   << ", \"moves\": " << detail::PerOperation(result.events.Moves(), result.iterations)
+                   << ", \"allocations\": " << detail::PerOperation(result.allocations.count, result.iterations)
+                   << ", \"bytes\": " << detail::PerOperation(result.allocations.bytes, result.iterations)
+                   << ", \"peak_rss_kb\": " << result.peakRss
+                   << ", \"threads\": " << result.threads
+                   << ", \"ops_per_sec_per_thread\": " << detail::Throughput(result)
+                   << ", \"cpu_ns_per_op\": " << detail::CpuTime(result);
+            for (std::size_t i = 0; i < PERF::EVENTS; ++i)
+            {
+                stream << ", \"" << detail::Key(static_cast<PERF::Event>(i)) << "\": ";
+                if (result.perf.Valid(static_cast<PERF::Event>(i)))
+                    stream << detail::PerOperation(result.perf[static_cast<PERF::Event>(i)], result.iterations);
+                else
+                    stream << "null";
+            }
+            stream << ", \"code_bytes\": " << result.codeBytes << '}';
+        }
+        stream << "\n  ]\n}\n";
+    }
+}
+
+#endif /* benchmark_h */
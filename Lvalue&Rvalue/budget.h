@@ -0,0 +1,106 @@
+#ifndef budget_h
+#define budget_h
+
+#include "counter.h"
+#include "relocate.h"
+#include "swap.h"
+#include "trace.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+ Бюджет копирований и перемещений: выражение должно выполнить не больше copies копирований и moves перемещений.
+ Проверка во время выполнения считает события через COUNTER::Counter<Types>, поэтому работает только в режиме TRACE_COUNTERS.
+ При превышении Report хранит фактические события и выводит разницу с бюджетом:
+ auto report = BUDGET::Expect<A>("Make_Shared_Forward<A>(a)", {.copies = 0, .moves = 1}, [&a] { FORWARD::Make_Shared_Forward<A>(a); });
+ if (!report) std::cerr << report;
+ // Make_Shared_Forward<A>(a): budget exceeded
+ //   copies: 1 > 0 (+1)
+ //   moves: 0 <= 1
+ //   events: copy constructor 1
+ Проверки при компиляции - концепты на свойствах типа, без запуска:
+ static_assert(BUDGET::NothrowMovable<Derived>);   // std::vector и QUEUE::Ring перемещают, а не копируют
+ static_assert(BUDGET::SwapWithoutMoves<int>);     // SWAP::swap - побайтовый обмен или swap-член
+ */
+namespace BUDGET
+{
+    /// Перемещение без исключений: std::move_if_noexcept перемещает, а не копирует
+    template<class T>
+    concept NothrowMovable = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+
+    /// Копирование - копирование байтов, без вызова конструктора
+    template<class T>
+    concept BitwiseCopyable = std::is_trivially_copyable_v<T>;
+
+    /// Рост std::vector<T> переносит элементы перемещением: копирование только если перемещение может бросить исключение
+    template<class T>
+    concept VectorGrowsByMove = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
+
+    /// SWAP::swap не вызывает ни конструкторов, ни операторов присваивания T
+    template<class T>
+    concept SwapWithoutMoves = SWAP::is_bitwise_swappable_v<T> || SWAP::has_member_swap_v<T> || SWAP::is_relocating_swappable_v<T>;
+
+    struct Budget
+    {
+        std::size_t copies = 0; // Конструкторы копирования и операторы присваивания копированием
+        std::size_t moves = 0;  // Конструкторы перемещения и операторы присваивания перемещением
+    };
+
+    /// Результат проверки, false - бюджет превышен
+    struct Report
+    {
+        explicit operator bool() const noexcept { return events.Copies() <= budget.copies && events.Moves() <= budget.moves; }
+
+        std::string name;
+        Budget budget;
+        COUNTER::Snapshot events;
+    };
+
+    inline std::ostream& operator<<(std::ostream& stream, const Report& report)
+    {
+        const auto line = [&stream](const char* name, std::size_t actual, std::size_t budget)
+        {
+            stream << "\n  " << name << ": " << actual;
+            if (actual > budget)
+                stream << " > " << budget << " (+" << actual - budget << ')';
+            else
+                stream << " <= " << budget;
+        };
+
+        stream << report.name << (report ? ": within budget" : ": budget exceeded");
+        line("copies", report.events.Copies(), report.budget.copies);
+        line("moves", report.events.Moves(), report.budget.moves);
+        stream << "\n  events:";
+        const char* separator = " ";
+        for (std::size_t i = 0; i < COUNTER::EVENTS; ++i)
+        {
+            if (const std::size_t count = report.events[static_cast<COUNTER::Event>(i)])
+            {
+                stream << separator << COUNTER::Name(static_cast<COUNTER::Event>(i)) << ' ' << count;
+                separator = ", ";
+            }
+        }
+        return stream << '\n';
+    }
+
+    /// Types - типы, чьи копирования и перемещения входят в бюджет, function() выполняется один раз
+    template<class... Types, class Function>
+    Report Expect(std::string name, Budget budget, Function&& function)
+    {
+        static_assert(TRACE_MODE == TRACE_COUNTERS, "BUDGET::Expect counts events through COUNTER::Counter: define TRACE_MODE TRACE_COUNTERS");
+        static_assert(sizeof...(Types) > 0, "BUDGET::Expect needs at least one counted type");
+
+        COUNTER::Snapshot before;
+        ((before += COUNTER::Counter<Types>::Get()), ...);
+        std::forward<Function>(function)();
+        COUNTER::Snapshot after;
+        ((after += COUNTER::Counter<Types>::Get()), ...);
+        return Report{std::move(name), budget, after - before};
+    }
+}
+
+#endif /* budget_h */
@@ -0,0 +1,502 @@
+#ifndef collector_h
+#define collector_h
+
+#include "counter.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+/*
+ Сборщик событий жизненного цикла без блокировок для многопоточной нагрузки.
+ Каждый поток пишет события в свое кольцо (SPSC: один производитель - сам поток, один потребитель - фоновый поток сборщика),
+ фоновый поток забирает события из всех колец и пишет их в двоичный файл. Горячий путь - запись 24 байт в кольцо и release-store индекса,
+ без блокировок и без общего std::cout. Если кольцо заполнено, событие отбрасывается и учитывается в Dropped().
+ Событие: время (TSC на x86, иначе наносекунды steady_clock), адрес объекта, номер потока, тип объекта, вид события.
+ Использование:
+ #define TRACE_MODE TRACE_COLLECTOR // До подключения заголовков
+ #include "lvalue_rvalue.h"
+ COLLECTOR::Collector::Start("events.bin");
+ ... // Потоки создают, копируют и перемещают объекты
+ COLLECTOR::Collector::Stop();
+ std::cout << COLLECTOR::Summarize("events.bin"); // Или ./summarize events.bin
+ Кольцо освобождается при завершении потока и переиспользуется новым потоком, память не растет при создании новых потоков.
+ События, совпавшие по времени со Stop(), могут быть потеряны.
+ */
+
+#ifndef COLLECTOR_RING_SIZE
+#define COLLECTOR_RING_SIZE 8192
+#endif
+
+namespace COLLECTOR
+{
+    using COUNTER::Event;
+
+    /// Событие фиксированного размера, в файле хранится как есть
+    struct Record
+    {
+        std::uint64_t timestamp; // Такты TSC или наносекунды
+        std::uint64_t object;    // Адрес объекта
+        std::uint32_t thread;    // Номер потока, начиная с 1
+        std::uint16_t type;      // Номер типа в таблице типов файла
+        std::uint8_t event;      // COUNTER::Event
+        std::uint8_t reserved;
+    };
+
+    static_assert(sizeof(Record) == 24);
+
+    /*
+     Формат файла:
+     Header | Record[records] | таблица типов: uint32 число типов, для каждого uint16 длина имени и имя без '\0'
+     */
+    struct Header
+    {
+        char magic[4] = {'L', 'V', 'R', 'C'};
+        std::uint32_t version = 1;
+        std::uint64_t records = 0;
+        std::uint64_t types = 0;              // Смещение таблицы типов
+        std::uint64_t dropped = 0;
+        double ticksPerNanosecond = 1.0;      // Для перевода timestamp в наносекунды
+    };
+
+    inline std::uint64_t Timestamp() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    class Collector
+    {
+        /// Кольцо одного потока: head пишет только производитель, tail - только потребитель
+        struct Ring
+        {
+            static constexpr std::size_t SIZE = COLLECTOR_RING_SIZE;
+            static_assert((SIZE & (SIZE - 1)) == 0, "COLLECTOR_RING_SIZE must be a power of two");
+
+            bool Push(const Record& record) noexcept
+            {
+                const std::size_t position = head.load(std::memory_order_relaxed);
+                if (position - cachedTail == SIZE)
+                {
+                    cachedTail = tail.load(std::memory_order_acquire);
+                    if (position - cachedTail == SIZE)
+                    {
+                        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+                }
+                records[position & (SIZE - 1)] = record;
+                head.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /// Передает накопленные события в write(const Record*, count) не более чем двумя непрерывными частями
+            template <class Write>
+            std::size_t Drain(Write&& write)
+            {
+                const std::size_t first = tail.load(std::memory_order_relaxed);
+                const std::size_t last = head.load(std::memory_order_acquire);
+                const std::size_t begin = first & (SIZE - 1);
+                const std::size_t count = last - first;
+                const std::size_t part = std::min(count, SIZE - begin);
+                if (part)
+                    write(&records[begin], part);
+                if (count > part)
+                    write(&records[0], count - part);
+                tail.store(last, std::memory_order_release);
+                return count;
+            }
+
+            std::array<Record, SIZE> records;
+            alignas(64) std::atomic<std::size_t> head{0};
+            std::size_t cachedTail = 0; // Последний прочитанный производителем tail
+            std::uint32_t thread = 0;   // Номер потока-владельца
+            alignas(64) std::atomic<std::size_t> tail{0};
+            alignas(64) std::atomic<std::size_t> dropped{0};
+            std::atomic<bool> owned{false};
+            Ring* next = nullptr;
+        };
+
+    public:
+        /// Запускает фоновый поток, пишущий события в файл path, false - сборщик уже запущен или файл не открылся
+        static bool Start(const std::string& path)
+        {
+            State& state = Instance();
+            std::lock_guard lock(state.mutex);
+            if (state.file)
+                return false;
+
+            state.file = std::fopen(path.c_str(), "wb");
+            if (!state.file)
+                return false;
+
+            // Потребителя нет, поэтому события прошлого запуска можно просто пропустить
+            for (Ring* ring = _head.load(std::memory_order_acquire); ring; ring = ring->next)
+            {
+                ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+                ring->dropped.store(0, std::memory_order_relaxed);
+            }
+
+            state.header = Header();
+            std::fwrite(&state.header, sizeof(Header), 1, state.file);
+            state.startTicks = Timestamp();
+            state.start = std::chrono::steady_clock::now();
+            state.stop.store(false, std::memory_order_relaxed);
+            _running.store(true, std::memory_order_release);
+            state.consumer = std::thread(Consume, std::ref(state));
+            return true;
+        }
+
+        /// Останавливает фоновый поток, дописывает оставшиеся события, таблицу типов и заголовок
+        static void Stop()
+        {
+            State& state = Instance();
+            std::lock_guard lock(state.mutex);
+            if (!state.file)
+                return;
+
+            _running.store(false, std::memory_order_release);
+            state.stop.store(true, std::memory_order_release);
+            state.consumer.join();
+            DrainAll(state);
+
+            const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - state.start).count();
+            state.header.ticksPerNanosecond = elapsed > 0.0 ? static_cast<double>(Timestamp() - state.startTicks) / elapsed : 1.0;
+            for (Ring* ring = _head.load(std::memory_order_acquire); ring; ring = ring->next)
+                state.header.dropped += ring->dropped.load(std::memory_order_relaxed);
+
+            state.header.types = sizeof(Header) + state.header.records * sizeof(Record);
+            {
+                std::lock_guard types(state.typesMutex);
+                const auto count = static_cast<std::uint32_t>(state.types.size());
+                std::fwrite(&count, sizeof(count), 1, state.file);
+                for (const std::string& name : state.types)
+                {
+                    const auto length = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), UINT16_MAX));
+                    std::fwrite(&length, sizeof(length), 1, state.file);
+                    std::fwrite(name.data(), 1, length, state.file);
+                }
+            }
+
+            std::fseek(state.file, 0, SEEK_SET);
+            std::fwrite(&state.header, sizeof(Header), 1, state.file);
+            std::fclose(state.file);
+            state.file = nullptr;
+        }
+
+        static bool Running() noexcept
+        {
+            return _running.load(std::memory_order_relaxed);
+        }
+
+        /// Число отброшенных событий из-за заполненного кольца с последнего Start()
+        static std::size_t Dropped() noexcept
+        {
+            std::size_t dropped = 0;
+            for (Ring* ring = _head.load(std::memory_order_acquire); ring; ring = ring->next)
+                dropped += ring->dropped.load(std::memory_order_relaxed);
+            return dropped;
+        }
+
+        /// Политика трассировки (trace.h): до Start() и после Stop() ничего не делает
+        template <class T>
+        static void Trace(const T* object, Event event) noexcept
+        {
+            if (!_running.load(std::memory_order_relaxed))
+                return;
+
+            Ring* ring = Local();
+            if (!ring)
+                return; // Поток завершается и уже вернул кольцо: события деструкторов thread_local не пишутся
+            ring->Push(Record{Timestamp(), reinterpret_cast<std::uintptr_t>(object), ring->thread, Type<T>(), static_cast<std::uint8_t>(event), 0});
+        }
+
+        template <class T>
+        static void Trace(const T* object, Event event, const char*) noexcept
+        {
+            Trace(object, event);
+        }
+
+    private:
+        /// Таблица типов - поля State: ~State (программа завершилась без Stop()) пишет ее в файл, поэтому она должна жить не меньше State
+        struct State
+        {
+            ~State()
+            {
+                if (file)
+                    Stop();
+            }
+
+            std::mutex typesMutex;
+            std::vector<std::string> types;
+            std::mutex mutex;
+            std::FILE* file = nullptr;
+            std::thread consumer;
+            std::atomic<bool> stop{false};
+            Header header;
+            std::uint64_t startTicks = 0;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        /// Кольцо потока без деструктора - доступ без проверки инициализации, returned - кольцо уже отдано при завершении потока
+        struct Thread
+        {
+            Ring* ring;
+            bool returned;
+        };
+
+        static Thread& LocalThread() noexcept
+        {
+            thread_local Thread thread{};
+            return thread;
+        }
+
+        /// Освобождает кольцо при завершении потока
+        struct Owner
+        {
+            ~Owner()
+            {
+                Thread& thread = LocalThread();
+                if (thread.ring)
+                    thread.ring->owned.store(false, std::memory_order_release);
+                thread = Thread{nullptr, true}; // Кольцо может достаться другому потоку: дальше этот поток в него не пишет
+            }
+        };
+
+        static State& Instance()
+        {
+            static State state;
+            return state;
+        }
+
+        /// Owner регистрируется один раз при первом событии потока, nullptr - поток завершается и уже вернул кольцо
+        static Ring* Local() noexcept
+        {
+            Thread& thread = LocalThread();
+            if (!thread.ring && !thread.returned)
+            {
+                thread.ring = Acquire();
+                thread_local Owner owner;
+                (void)owner;
+            }
+            return thread.ring;
+        }
+
+        /// Свободное кольцо завершенного потока или новое, кольца не освобождаются (как слоты COUNTER::Counter)
+        static Ring* Acquire() noexcept
+        {
+            static std::atomic<std::uint32_t> threads{0};
+            const std::uint32_t thread = threads.fetch_add(1, std::memory_order_relaxed) + 1;
+
+            for (Ring* ring = _head.load(std::memory_order_acquire); ring; ring = ring->next)
+            {
+                bool owned = false;
+                if (ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    ring->thread = thread;
+                    return ring;
+                }
+            }
+
+            Ring* ring = new Ring;
+            ring->thread = thread;
+            ring->owned.store(true, std::memory_order_relaxed);
+            ring->next = _head.load(std::memory_order_relaxed);
+            while (!_head.compare_exchange_weak(ring->next, ring, std::memory_order_release, std::memory_order_relaxed));
+            return ring;
+        }
+
+        /// Номер типа назначается один раз при первом событии типа T
+        template <class T>
+        static std::uint16_t Type() noexcept
+        {
+            static const std::uint16_t type = Register(typeid(T).name());
+            return type;
+        }
+
+        /// Без памяти под имя - UNKNOWN: события типа считаются, но в итоге Summarize без имени не выводятся
+        static std::uint16_t Register(const char* name) noexcept
+        {
+            try
+            {
+                std::string demangled = name;
+#if defined(__GNUG__)
+                int status = 0;
+                if (char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status))
+                {
+                    demangled = readable;
+                    std::free(readable);
+                }
+#endif
+                State& state = Instance();
+                std::lock_guard lock(state.typesMutex);
+                state.types.push_back(std::move(demangled));
+                return static_cast<std::uint16_t>(state.types.size() - 1);
+            }
+            catch (...)
+            {
+                return UNKNOWN;
+            }
+        }
+
+        static constexpr std::uint16_t UNKNOWN = UINT16_MAX;
+
+        static std::size_t DrainAll(State& state)
+        {
+            std::size_t count = 0;
+            for (Ring* ring = _head.load(std::memory_order_acquire); ring; ring = ring->next)
+            {
+                count += ring->Drain([&state](const Record* records, std::size_t size)
+                {
+                    std::fwrite(records, sizeof(Record), size, state.file);
+                    state.header.records += size;
+                });
+            }
+            return count;
+        }
+
+        /// Фоновый поток: забирает события из колец, если событий нет - засыпает
+        static void Consume(State& state)
+        {
+            while (!state.stop.load(std::memory_order_acquire))
+            {
+                if (!DrainAll(state))
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+
+        static inline std::atomic<Ring*> _head{nullptr};
+        static inline std::atomic<bool> _running{false};
+    };
+
+    /// Итог по файлу сборщика
+    struct Summary
+    {
+        struct Type
+        {
+            std::string name;
+            COUNTER::Snapshot events;
+        };
+
+        std::uint64_t records = 0;
+        std::uint64_t dropped = 0;
+        double nanoseconds = 0.0;                    // От первого до последнего события
+        std::vector<Type> types;                      // По убыванию числа копирований
+        std::map<std::uint32_t, std::uint64_t> threads; // Число событий каждого потока
+    };
+
+    /// Читает файл сборщика, при ошибке формата - std::runtime_error
+    inline Summary Summarize(const std::string& path)
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            throw std::runtime_error("COLLECTOR: cannot open " + path);
+
+        struct Closer
+        {
+            ~Closer() { std::fclose(file); }
+            std::FILE* file;
+        } closer{file};
+
+        Header header;
+        if (std::fread(&header, sizeof(Header), 1, file) != 1 || std::memcmp(header.magic, "LVRC", 4) != 0 || header.version != 1)
+            throw std::runtime_error("COLLECTOR: " + path + " is not a collector file");
+
+        Summary summary;
+        summary.records = header.records;
+        summary.dropped = header.dropped;
+
+        std::vector<COUNTER::Snapshot> events;
+        std::uint64_t first = UINT64_MAX, last = 0;
+        std::vector<Record> records(4096);
+        for (std::uint64_t left = header.records; left;)
+        {
+            const std::size_t count = std::fread(records.data(), sizeof(Record), static_cast<std::size_t>(std::min<std::uint64_t>(left, records.size())), file);
+            if (!count)
+                throw std::runtime_error("COLLECTOR: " + path + " is truncated");
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const Record& record = records[i];
+                if (record.type >= events.size())
+                    events.resize(record.type + 1);
+                if (record.event < COUNTER::EVENTS)
+                    ++events[record.type][static_cast<Event>(record.event)];
+                ++summary.threads[record.thread];
+                first = std::min(first, record.timestamp);
+                last = std::max(last, record.timestamp);
+            }
+            left -= count;
+        }
+        if (header.records)
+            summary.nanoseconds = static_cast<double>(last - first) / header.ticksPerNanosecond;
+
+        std::uint32_t types = 0;
+        if (std::fseek(file, static_cast<long>(header.types), SEEK_SET) != 0 || std::fread(&types, sizeof(types), 1, file) != 1)
+            throw std::runtime_error("COLLECTOR: " + path + " has no type table");
+
+        for (std::uint32_t i = 0; i < types; ++i)
+        {
+            std::uint16_t length = 0;
+            std::string name;
+            if (std::fread(&length, sizeof(length), 1, file) != 1)
+                throw std::runtime_error("COLLECTOR: " + path + " has a broken type table");
+            name.resize(length);
+            if (length && std::fread(name.data(), 1, length, file) != length)
+                throw std::runtime_error("COLLECTOR: " + path + " has a broken type table");
+            if (i < events.size())
+                summary.types.push_back({std::move(name), events[i]});
+        }
+
+        std::stable_sort(summary.types.begin(), summary.types.end(), [](const Summary::Type& lhs, const Summary::Type& rhs)
+        {
+            return lhs.events.Copies() > rhs.events.Copies();
+        });
+        return summary;
+    }
+
+    /// Таблица: тип, число событий каждого вида, копирования, перемещения
+    inline std::ostream& operator<<(std::ostream& stream, const Summary& summary)
+    {
+        stream << "records: " << summary.records << ", dropped: " << summary.dropped << ", threads: " << summary.threads.size()
+               << ", duration: " << summary.nanoseconds / 1e6 << " ms\n";
+        for (const Summary::Type& type : summary.types)
+        {
+            stream << type.name << "\n";
+            for (std::size_t i = 0; i < COUNTER::EVENTS; ++i)
+                stream << "  " << std::left << std::setw(18) << COUNTER::Name(static_cast<Event>(i)) << type.events[static_cast<Event>(i)] << "\n";
+            stream << "  " << std::left << std::setw(18) << "copies" << type.events.Copies() << "\n";
+            stream << "  " << std::left << std::setw(18) << "moves" << type.events.Moves() << "\n";
+        }
+        return stream;
+    }
+}
+
+#endif /* collector_h */
@@ -0,0 +1,138 @@
+#ifndef counter_h
+#define counter_h
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/*
+ Счетчик вызовов специальных функций-членов (конструкторов, операторов присваивания, деструктора).
+ Вместо чтения вывода std::cout можно получить точное число копирований и перемещений в виде чисел:
+ auto before = COUNTER::Counter<Derived>::Get();
+ Derived derived = getDerived1();
+ auto after = COUNTER::Counter<Derived>::Get();
+ (after - before)[COUNTER::Event::CopyConstructor] // 0 - копирования не было
+ Счетчики свои для каждого типа T, поэтому Derived и FORWARD::A не мешают друг другу.
+ Каждый поток пишет только в свой слот (relaxed атомарные операции без lock-префикса), Get() суммирует слоты всех потоков.
+ Слот потока не освобождается после его завершения: он остается в списке и его значения продолжают учитываться в Get().
+ */
+namespace COUNTER
+{
+    enum class Event : std::size_t
+    {
+        Constructor,     // Обычный конструктор
+        CopyConstructor, // Конструктор копирования
+        MoveConstructor, // Конструктор перемещения
+        CopyAssignment,  // Оператор присваивания копированием
+        MoveAssignment,  // Оператор присваивания перемещением
+        Destructor,      // Деструктор
+        Count
+    };
+
+    constexpr std::size_t EVENTS = static_cast<std::size_t>(Event::Count);
+
+    constexpr const char* Name(Event event) noexcept
+    {
+        switch (event)
+        {
+            case Event::Constructor:     return "constructor";
+            case Event::CopyConstructor: return "copy constructor";
+            case Event::MoveConstructor: return "move constructor";
+            case Event::CopyAssignment:  return "copy operator=";
+            case Event::MoveAssignment:  return "move operator=";
+            case Event::Destructor:      return "destructor";
+            default:                     return "unknown";
+        }
+    }
+
+    /// Снимок счетчиков, индексируется событием
+    class Snapshot
+    {
+    public:
+        std::size_t& operator[](Event event) noexcept { return _events[static_cast<std::size_t>(event)]; }
+        std::size_t operator[](Event event) const noexcept { return _events[static_cast<std::size_t>(event)]; }
+
+        std::size_t Copies() const noexcept { return (*this)[Event::CopyConstructor] + (*this)[Event::CopyAssignment]; }
+        std::size_t Moves() const noexcept { return (*this)[Event::MoveConstructor] + (*this)[Event::MoveAssignment]; }
+
+        Snapshot& operator+=(const Snapshot& other) noexcept
+        {
+            for (std::size_t i = 0; i < EVENTS; ++i)
+                _events[i] += other._events[i];
+            return *this;
+        }
+
+        friend Snapshot operator-(Snapshot lhs, const Snapshot& rhs) noexcept
+        {
+            for (std::size_t i = 0; i < EVENTS; ++i)
+                lhs._events[i] -= rhs._events[i];
+            return lhs;
+        }
+
+    private:
+        std::array<std::size_t, EVENTS> _events{};
+    };
+
+    template <class T>
+    class Counter
+    {
+        /// Счетчики одного потока, пишет только владелец, читают все
+        struct Slot
+        {
+            std::array<std::atomic<std::size_t>, EVENTS> events{};
+            Slot* next = nullptr;
+        };
+
+    public:
+        static void Add(Event event) noexcept
+        {
+            auto& counter = Local().events[static_cast<std::size_t>(event)];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static Snapshot Get() noexcept
+        {
+            Snapshot snapshot;
+            for (Slot* slot = _head.load(std::memory_order_acquire); slot; slot = slot->next)
+            {
+                for (std::size_t i = 0; i < EVENTS; ++i)
+                    snapshot[static_cast<Event>(i)] += slot->events[i].load(std::memory_order_relaxed);
+            }
+            return snapshot;
+        }
+
+        /// Не синхронизирован с Add() других потоков, вызывать, когда они не работают с T
+        static void Reset() noexcept
+        {
+            for (Slot* slot = _head.load(std::memory_order_acquire); slot; slot = slot->next)
+            {
+                for (auto& counter : slot->events)
+                    counter.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        static Slot& Local() noexcept
+        {
+            // Указатель без деструктора: счетчики работают и во время уничтожения глобальных объектов
+            thread_local Slot* local = nullptr;
+            if (!local)
+            {
+                // malloc, а не new: замененный operator new (allocation.h) посчитал бы слот выделением памяти в сценарии
+                void* memory = std::malloc(sizeof(Slot));
+                if (!memory)
+                    std::abort();
+                local = ::new (memory) Slot;
+                local->next = _head.load(std::memory_order_relaxed);
+                while (!_head.compare_exchange_weak(local->next, local, std::memory_order_release, std::memory_order_relaxed));
+            }
+            return *local;
+        }
+
+        static inline std::atomic<Slot*> _head{nullptr};
+    };
+}
+
+#endif /* counter_h */
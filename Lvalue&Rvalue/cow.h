@@ -0,0 +1,232 @@
+#ifndef cow_h
+#define cow_h
+
+#include "lvalue_rvalue.h"
+#include "relocate.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/*
+ Copy-on-write: текст в общем неизменяемом блоке со счетчиком ссылок, копия объекта - только увеличение счетчика.
+ Для раздачи одной записи многим получателям (fan-out), где каждый const Derived& в контейнере - полная копия _text:
+ Derived derivedRef6 = std::move(derivedRef2); // const объект: std::string копирует текст, COW::String - увеличивает счетчик
+ Изменение через неконстантный доступ (operator[], Mutable(), assign, append) отделяет копию (detach): если блок общий,
+ текст копируется в новый блок, остальные владельцы его не видят.
+ Mutable() и неконстантный operator[] выдают char* / char& в блок, поэтому блок становится неразделяемым: следующие копии строки
+ копируют текст, а не увеличивают счетчик, иначе запись через сохраненный указатель изменила бы и копию.
+ Указатель действителен до следующего assign, append, присваивания или уничтожения строки, после assign/append блок снова разделяемый.
+ Счетчик ссылок:
+ - COW::Local - обычное целое для одного потока, копия - одна инструкция без lock-префикса;
+ - COW::Shared - std::atomic, копии можно передавать между потоками (атомарный инкремент в общей кэш-линии).
+ COW::Derived (Shared) и COW::LocalDerived (Local) - lvalue_rvalue::BasicDerived с таким текстом.
+ COW::Derived derived;
+ derived.SetText(std::string(1 << 20, 't'));
+ COW::Derived copy = derived;   // Без копирования 1 МБ
+ copy.GetText()[0] = 'x';       // Отделение: copy получает свой блок
+ */
+namespace COW
+{
+    /// Счетчик ссылок для одного потока
+    struct Local
+    {
+        using Count = std::size_t;
+
+        static void Increment(Count& count) noexcept { ++count; }
+        /// true - ссылка была последней
+        static bool Release(Count& count) noexcept { return --count == 0; }
+        static std::size_t Get(const Count& count) noexcept { return count; }
+    };
+
+    /// Атомарный счетчик ссылок, как у std::shared_ptr
+    struct Shared
+    {
+        using Count = std::atomic<std::size_t>;
+
+        static void Increment(Count& count) noexcept { count.fetch_add(1, std::memory_order_relaxed); }
+        static bool Release(Count& count) noexcept { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+        static std::size_t Get(const Count& count) noexcept { return count.load(std::memory_order_acquire); }
+    };
+
+    /// Строка с общим блоком текста, пустая строка не выделяет память
+    template<class Threading = Shared>
+    class String
+    {
+        /// Заголовок блока, за ним size + 1 символов
+        struct Body
+        {
+            typename Threading::Count count;
+            std::size_t size;
+            bool shareable = true; // false - выдан указатель для изменения, копии получают свой блок
+
+            char* Data() noexcept { return reinterpret_cast<char*>(this + 1); }
+        };
+
+    public:
+        String() noexcept = default;
+
+        String(std::string_view text) :
+        _body(Make(text))
+        {
+
+        }
+
+        String(const char* text) :
+        String(std::string_view(text))
+        {
+
+        }
+
+        String(const std::string& text) :
+        String(std::string_view(text))
+        {
+
+        }
+
+        /// Разделяемый блок - только увеличение счетчика, неразделяемый - копирование текста
+        String(const String& other) :
+        _body(Share(other._body))
+        {
+
+        }
+
+        String(String&& other) noexcept :
+        _body(std::exchange(other._body, nullptr))
+        {
+
+        }
+
+        String& operator=(const String& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            String(other).swap(*this);
+            return *this;
+        }
+
+        String& operator=(String&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            String(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        ~String()
+        {
+            Release(_body);
+        }
+
+        void swap(String& other) noexcept
+        {
+            std::swap(_body, other._body);
+        }
+
+        const char* data() const noexcept { return _body ? _body->Data() : ""; }
+        std::size_t size() const noexcept { return _body ? _body->size : 0; }
+        bool empty() const noexcept { return size() == 0; }
+        const char& operator[](std::size_t index) const noexcept { return data()[index]; }
+
+        operator std::string_view() const noexcept { return {data(), size()}; }
+
+        /// Число владельцев блока, 0 - пустая строка
+        std::size_t use_count() const noexcept { return _body ? Threading::Get(_body->count) : 0; }
+
+        /// Символы для изменения: общий блок сначала копируется, затем перестает разделяться.
+        /// У пустой строки блока нет - завершающий '\0', как operator[](size()) у std::string: записывать в него можно только '\0'
+        char* Mutable()
+        {
+            Detach();
+            if (!_body)
+            {
+                static char terminator = '\0';
+                return &terminator;
+            }
+            _body->shareable = false;
+            return _body->Data();
+        }
+
+        char& operator[](std::size_t index) { return Mutable()[index]; }
+
+        void assign(std::string_view text)
+        {
+            String(text).swap(*this);
+        }
+
+        void append(std::string_view text)
+        {
+            if (text.empty())
+                return;
+
+            Body* body = Allocate(size() + text.size());
+            std::memcpy(body->Data(), data(), size());
+            std::memcpy(body->Data() + size(), text.data(), text.size());
+            Release(std::exchange(_body, body));
+        }
+
+        friend bool operator==(const String& lhs, const String& rhs) noexcept
+        {
+            return lhs._body == rhs._body || std::string_view(lhs) == std::string_view(rhs);
+        }
+
+    private:
+        static Body* Allocate(std::size_t size)
+        {
+            Body* body = ::new (::operator new(sizeof(Body) + size + 1)) Body{{1}, size};
+            body->Data()[size] = '\0';
+            return body;
+        }
+
+        static Body* Make(std::string_view text)
+        {
+            if (text.empty())
+                return nullptr;
+
+            Body* body = Allocate(text.size());
+            std::memcpy(body->Data(), text.data(), text.size());
+            return body;
+        }
+
+        static Body* Share(Body* body)
+        {
+            if (!body)
+                return nullptr;
+            if (!body->shareable)
+                return Make({body->Data(), body->size});
+            Threading::Increment(body->count);
+            return body;
+        }
+
+        static void Release(Body* body) noexcept
+        {
+            if (body && Threading::Release(body->count))
+            {
+                body->~Body();
+                ::operator delete(body);
+            }
+        }
+
+        /// Единственный владелец меняет блок на месте, иначе - своя копия
+        void Detach()
+        {
+            if (_body && Threading::Get(_body->count) != 1)
+                Release(std::exchange(_body, Make(*this)));
+        }
+
+        Body* _body = nullptr;
+    };
+
+    using Derived = lvalue_rvalue::BasicDerived<String<Shared>>;
+    using LocalDerived = lvalue_rvalue::BasicDerived<String<Local>>;
+
+    static_assert(sizeof(String<>) == sizeof(void*));
+    static_assert(std::is_nothrow_move_constructible_v<String<>>);
+}
+
+/// Объект - только указатель на блок, блок не ссылается на объект
+template<class Threading>
+struct RELOCATE::is_trivially_relocatable<COW::String<Threading>> : std::true_type {};
+
+#endif /* cow_h */
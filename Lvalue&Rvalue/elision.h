@@ -0,0 +1,133 @@
+#ifndef elision_h
+#define elision_h
+
+#include "budget.h"
+#include "lvalue_rvalue.h"
+
+#include <optional>
+#include <utility>
+
+/*
+ Формы возврата и инициализации, для которых пропуск копирования (copy elision) проверяется счетчиками, а не комментариями.
+ - Возврат prvalue (getDerived2) - гарантированный пропуск с C++17: 0 копирований и 0 перемещений при любых флагах.
+ - NRVO (getDerived1, NamedBranches, Constant) - разрешенный, но не обязательный пропуск: -fno-elide-constructors его отключает,
+   тогда возвращаемый объект перемещается (const объект - копируется).
+ - Неявное перемещение: return имени локального объекта или параметра по значению, если NRVO невозможен (Either, Parameter, Converted).
+ - Не имя объекта (Ternary, Member) - копирование: return flag ? first : second; неявного перемещения для такого выражения нет.
+ - std::move в return (Moved) - всегда перемещение, он запрещает NRVO.
+ Ожидаемые числа - ELISION::Expected(elided, unelided): первое - обычная сборка, второе - сборка с -fno-elide-constructors
+ (cmake -DLVALUE_RVALUE_NO_ELIDE=ON определяет макрос LVALUE_RVALUE_NO_ELIDE). Группа elision бенчмарка сравнивает с ними
+ фактические события, больше ожидаемого - ошибка бенчмарка:
+ ./benchmark --format table elision
+ */
+namespace ELISION
+{
+    using lvalue_rvalue::Derived;
+
+#ifdef LVALUE_RVALUE_NO_ELIDE
+    /// Сборка с -fno-elide-constructors: остается только гарантированный пропуск prvalue
+    inline constexpr bool NRVO = false;
+#else
+    inline constexpr bool NRVO = true;
+#endif
+
+    /// Бюджет для текущей сборки: elided - с NRVO, unelided - с -fno-elide-constructors
+    constexpr BUDGET::Budget Expected(BUDGET::Budget elided, BUDGET::Budget unelided) noexcept
+    {
+        return NRVO ? elided : unelided;
+    }
+
+    /// NRVO с несколькими return одного и того же объекта
+    inline Derived NamedBranches(bool flag)
+    {
+        Derived derived;
+        if (flag)
+        {
+            derived._number = 1;
+            return derived;
+        }
+        derived._number = 2;
+        return derived;
+    }
+
+    /// Два объекта, возвращаемый выбирается при выполнении: NRVO невозможен, неявное перемещение
+    inline Derived Either(bool flag)
+    {
+        Derived first, second;
+        second._number = 2;
+        if (flag)
+            return first;
+        return second;
+    }
+
+    /// Условный оператор - lvalue, а не имя объекта: копирование
+    inline Derived Ternary(bool flag)
+    {
+        Derived first, second;
+        second._number = 2;
+        return flag ? first : second;
+    }
+
+    /// Объекты в непересекающихся областях видимости: NRVO зависит от компилятора, иначе неявное перемещение
+    inline Derived Scoped(bool flag)
+    {
+        if (flag)
+        {
+            Derived first;
+            return first;
+        }
+        Derived second;
+        second._number = 2;
+        return second;
+    }
+
+    /// Поле локального объекта - не имя объекта: копирование
+    inline Derived Member()
+    {
+        std::pair<Derived, int> pair;
+        return pair.first;
+    }
+
+    /// Поле локального объекта с std::move: перемещение
+    inline Derived MovedMember()
+    {
+        std::pair<Derived, int> pair;
+        return std::move(pair.first);
+    }
+
+    /// Параметр по значению не может быть NRVO (его создает вызывающий): неявное перемещение
+    inline Derived Parameter(Derived derived)
+    {
+        return derived;
+    }
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpessimizing-move"
+#endif
+    /// std::move в return запрещает NRVO: всегда перемещение
+    inline Derived Moved()
+    {
+        Derived derived;
+        return std::move(derived);
+    }
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+    /// const объект: NRVO разрешен, но без него перемещать нельзя - копирование
+    inline Derived Constant()
+    {
+        const Derived derived;
+        return derived;
+    }
+
+    /// Другой тип результата: объект перемещается в std::optional (неявное перемещение), NRVO невозможен
+    inline std::optional<Derived> Converted()
+    {
+        Derived derived;
+        return derived;
+    }
+}
+
+#endif /* elision_h */
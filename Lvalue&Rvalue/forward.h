@@ -4,6 +4,9 @@
 #include "lvalue_rvalue.h"
 #include "move.h"
 
+#include <memory>
+#include <memory_resource>
+
 
 /*
  std::forward - идеальной передача (perfect forwarding).
@@ -59,10 +62,10 @@ namespace FORWARD
     class A
     {
     public:
-        A() { std::cout << "A construtor" << std::endl; } // Обычный конструктор
-        A(A&&) { std::cout << "A&& construtor" << std::endl; } // Конструктор перемещения
-        A(A&) { std::cout << "A& construtor" << std::endl; } // Конструктор копирования
-        A(const A&) { std::cout << "const A& construtor" << std::endl; } // Конструктор копирования перекроет
+        A() { TRACE::Trace(this, TRACE::Event::Constructor, "A construtor"); } // Обычный конструктор
+        A(A&&) { TRACE::Trace(this, TRACE::Event::MoveConstructor, "A&& construtor"); } // Конструктор перемещения
+        A(A&) { TRACE::Trace(this, TRACE::Event::CopyConstructor, "A& construtor"); } // Конструктор копирования
+        A(const A&) { TRACE::Trace(this, TRACE::Event::CopyConstructor, "const A& construtor"); } // Конструктор копирования перекроет
     };
 
     template<typename T>
@@ -73,17 +76,46 @@ namespace FORWARD
         lvalue_rvalue::priority::function(FORWARD::forward<T>(arg));
     }
 
-    template<class T, typename Args>
-    std::shared_ptr<T> Make_Shared(Args&& args)
+    /// Без std::forward: аргументы внутри функции - lvalue, поэтому всегда копирование
+    template<class T, typename... Args>
+    std::shared_ptr<T> Make_Shared(Args&&... args)
+    {
+        return std::make_shared<T>(args...);
+    }
+
+    /*
+     С std::forward: каждый аргумент передается со своей категорией значения (Args, а не T), lvalue - копируется, rvalue - перемещается.
+     std::make_shared/std::allocate_shared выделяют память под объект и блок управления (счетчики ссылок) одним вызовом.
+     */
+    template<class T, typename... Args>
+    std::shared_ptr<T> Make_Shared_Forward(Args&&... args)
     {
-        return std::make_shared<T>(args);
+        return std::make_shared<T>(FORWARD::forward<Args>(args)...);
     }
 
-    template<class T, typename Args>
-    std::shared_ptr<T> Make_Shared_Forward(Args&& args)
+    template<class T, typename... Args>
+    std::unique_ptr<T> Make_Unique(Args&&... args)
     {
-        return std::make_shared<T>(FORWARD::forward<T>(args));
+        return std::unique_ptr<T>(new T(FORWARD::forward<Args>(args)...));
+    }
+
+    /// Объект и блок управления в одном выделении памяти через пользовательский аллокатор
+    template<class T, class Allocator, typename... Args>
+    std::shared_ptr<T> Allocate_Shared(const Allocator& allocator, Args&&... args)
+    {
+        return std::allocate_shared<T>(allocator, FORWARD::forward<Args>(args)...);
+    }
+
+    /// Объект и блок управления в арене (например, std::pmr::monotonic_buffer_resource), арена должна жить дольше объекта
+    template<class T, typename... Args>
+    std::shared_ptr<T> Make_Shared_Arena(std::pmr::memory_resource* arena, Args&&... args)
+    {
+        return FORWARD::Allocate_Shared<T>(std::pmr::polymorphic_allocator<T>(arena), FORWARD::forward<Args>(args)...);
     }
 }
 
+/// У A нет состояния, поэтому перенос побайтовым копированием корректен, хотя конструкторы пользовательские
+template<>
+struct RELOCATE::is_trivially_relocatable<FORWARD::A> : std::true_type {};
+
 #endif /* forward_h */
@@ -0,0 +1,279 @@
+#ifndef generator_h
+#define generator_h
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ Генератор на сопрограммах C++20 и стадии конвейера: значения передаются только перемещением, копирование - ошибка компиляции.
+ - co_yield принимает только rvalue: co_yield std::move(derived) или co_yield Derived(). Значение остается на месте -
+   в кадре сопрограммы, promise хранит только его адрес, поэтому сам co_yield ничего не перемещает.
+ - *it возвращает T&&: потребитель забирает значение перемещением (или читает на месте) до следующего ++it.
+ - Стадии Map, Filter и Batch - тоже сопрограммы: каждая запрашивает следующее значение у предыдущей, только когда его запросили у нее.
+   Это естественное обратное давление (back pressure): в конвейере в каждый момент живет по одному значению на стадию
+   и одна пачка на Batch, память не зависит от длины потока.
+ auto pipeline = Deriveds(count)
+               | GENERATOR::Map([](Derived&& derived) { derived._number *= 2; return std::move(derived); })
+               | GENERATOR::Filter([](const Derived& derived) { return derived._number % 3 == 0; })
+               | GENERATOR::Batch(1024);
+ for (std::vector<Derived>&& batch : pipeline) ... // Пачки по 1024 объекта, каждый перемещен дважды (Map и Batch)
+ */
+namespace GENERATOR
+{
+    template<class T>
+    class Generator
+    {
+        static_assert(std::is_object_v<T> && !std::is_const_v<T>, "GENERATOR::Generator<T> yields values that are moved out: T must be a non-const object type");
+
+    public:
+        struct promise_type
+        {
+            Generator get_return_object() noexcept
+            {
+                return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            /// Тело начинает выполняться только при первом запросе значения
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            /// Только rvalue: временный объект или std::move(x) живет в кадре сопрограммы до возобновления
+            std::suspend_always yield_value(T&& value) noexcept
+            {
+                _value = std::addressof(value);
+                return {};
+            }
+
+            void return_void() const noexcept {}
+
+            void unhandled_exception() noexcept
+            {
+                _exception = std::current_exception();
+            }
+
+            /// co_await внутри генератора не поддерживается
+            template<class U>
+            std::suspend_never await_transform(U&&) = delete;
+
+            T* _value = nullptr;
+            std::exception_ptr _exception;
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        class iterator
+        {
+        public:
+            using value_type = T;
+            using reference = T&&;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            iterator() noexcept = default;
+
+            explicit iterator(handle_type handle) noexcept :
+            _handle(handle)
+            {
+
+            }
+
+            reference operator*() const noexcept
+            {
+                return std::move(*_handle.promise()._value);
+            }
+
+            iterator& operator++()
+            {
+                Resume(_handle);
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept
+            {
+                return !it._handle || it._handle.done();
+            }
+
+        private:
+            handle_type _handle;
+        };
+
+        Generator() noexcept = default;
+
+        Generator(Generator&& other) noexcept :
+        _handle(std::exchange(other._handle, nullptr))
+        {
+
+        }
+
+        Generator& operator=(Generator&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            Generator(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        ~Generator()
+        {
+            if (_handle)
+                _handle.destroy();
+        }
+
+        void swap(Generator& other) noexcept
+        {
+            std::swap(_handle, other._handle);
+        }
+
+        /// Первое значение вычисляется здесь, begin() вызывается один раз: генератор - однопроходный диапазон
+        iterator begin()
+        {
+            if (_handle)
+                Resume(_handle);
+            return iterator(_handle);
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return {};
+        }
+
+    private:
+        explicit Generator(handle_type handle) noexcept :
+        _handle(handle)
+        {
+
+        }
+
+        /// Исключение из тела сопрограммы пробрасывается потребителю
+        static void Resume(handle_type handle)
+        {
+            handle.resume();
+            if (handle.done() && handle.promise()._exception)
+                std::rethrow_exception(std::exchange(handle.promise()._exception, nullptr));
+        }
+
+        handle_type _handle;
+    };
+
+    static_assert(std::input_iterator<Generator<int>::iterator>);
+    static_assert(std::is_same_v<std::iter_reference_t<Generator<int>::iterator>, int&&>);
+
+    /// Значение стадии function(std::move(value)): function должна возвращать объект, а не ссылку
+    template<class T, class Function>
+    Generator<std::invoke_result_t<Function&, T&&>> Map(Generator<T> source, Function function)
+    {
+        static_assert(std::is_object_v<std::invoke_result_t<Function&, T&&>>, "GENERATOR::Map function must return a value, not a reference");
+
+        for (T&& value : source)
+            co_yield std::invoke(function, std::move(value));
+    }
+
+    /// Значения, для которых predicate(const T&) == true, передаются дальше без перемещения внутри стадии
+    template<class T, class Predicate>
+    Generator<T> Filter(Generator<T> source, Predicate predicate)
+    {
+        for (T&& value : source)
+        {
+            if (std::invoke(predicate, std::as_const(value)))
+                co_yield std::move(value);
+        }
+    }
+
+    namespace detail
+    {
+        template<class T>
+        Generator<std::vector<T>> Batch(Generator<T> source, std::size_t size)
+        {
+            std::vector<T> batch;
+            batch.reserve(size);
+            for (T&& value : source)
+            {
+                batch.push_back(std::move(value));
+                if (batch.size() == size)
+                {
+                    co_yield std::move(batch);
+                    batch.clear();
+                    batch.reserve(size);
+                }
+            }
+            if (!batch.empty())
+                co_yield std::move(batch);
+        }
+    }
+
+    /*
+     Пачки по size значений (последняя - меньше), значения перемещаются в пачку.
+     Если потребитель не забрал пачку перемещением, ее память используется для следующей пачки.
+     size == 0 - std::invalid_argument сразу при построении конвейера, а не при первом ++it (тело сопрограммы ленивое).
+     */
+    template<class T>
+    Generator<std::vector<T>> Batch(Generator<T> source, std::size_t size)
+    {
+        if (size == 0)
+            throw std::invalid_argument("GENERATOR::Batch: size must be positive");
+        return detail::Batch(std::move(source), size);
+    }
+
+    namespace detail
+    {
+        /// Стадия без источника: source | Map(function)
+        template<class Stage>
+        struct Closure
+        {
+            Stage stage;
+        };
+
+        template<class Stage>
+        Closure(Stage) -> Closure<Stage>;
+    }
+
+    template<class T, class Stage>
+    auto operator|(Generator<T>&& source, detail::Closure<Stage> closure)
+    {
+        return std::move(closure.stage)(std::move(source));
+    }
+
+    template<class Function>
+    auto Map(Function function)
+    {
+        return detail::Closure{[function = std::move(function)]<class T>(Generator<T> source) mutable
+        {
+            return Map(std::move(source), std::move(function));
+        }};
+    }
+
+    template<class Predicate>
+    auto Filter(Predicate predicate)
+    {
+        return detail::Closure{[predicate = std::move(predicate)]<class T>(Generator<T> source) mutable
+        {
+            return Filter(std::move(source), std::move(predicate));
+        }};
+    }
+
+    inline auto Batch(std::size_t size)
+    {
+        if (size == 0)
+            throw std::invalid_argument("GENERATOR::Batch: size must be positive");
+        return detail::Closure{[size]<class T>(Generator<T> source)
+        {
+            return Batch(std::move(source), size);
+        }};
+    }
+}
+
+#endif /* generator_h */
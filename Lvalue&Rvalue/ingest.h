@@ -0,0 +1,112 @@
+#ifndef ingest_h
+#define ingest_h
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+/*
+ Пакетная загрузка диапазона в контейнер (std::vector, RELOCATE::Vector, std::deque): один reserve и перемещение везде, где оно допустимо.
+ Как передается каждый элемент, определяется при компиляции по типу ссылки диапазона:
+ - prvalue (генератор, std::views::transform) и rvalue (std::move_iterator) - перемещение;
+ - диапазон-контейнер, переданный как rvalue (INGEST::Append(deriveds, std::move(source))) - элементы перемещаются из него;
+ - lvalue - копирование: чужой контейнер не портится, для перемещения - std::move(source) или std::move_iterator;
+ - const lvalue и const rvalue (std::move(constDerived)) - копирование, которое выглядит как перемещение:
+   с Policy::Reject не компилируется, с Policy::Report попадает в Report::copied.
+ Память выделяется один раз: по размеру диапазона (std::ranges::sized_range) или по подсказке expected для потока неизвестной длины.
+ INGEST::Report report = INGEST::Append(deriveds, std::views::iota(0, 1000) | std::views::transform([](int) { return Derived(); }));
+ report.moved; // 1000
+ INGEST::Append<INGEST::Policy::Reject>(deriveds, constDeriveds); // Не скомпилируется
+ */
+namespace INGEST
+{
+    enum class Policy
+    {
+        Report, // const источник копируется и попадает в Report::copied
+        Reject  // const источник - ошибка компиляции
+    };
+
+    struct Report
+    {
+        std::size_t moved = 0;  // Элементы, созданные перемещением (или из prvalue)
+        std::size_t copied = 0; // Элементы, созданные копированием
+    };
+
+    /// Как передается элемент диапазона Range в контейнер
+    enum class Transfer
+    {
+        Move,
+        Copy,      // Обычное копирование lvalue
+        ConstCopy  // Копирование const источника, в том числе std::move(const)
+    };
+
+    template<class Range>
+    constexpr Transfer TransferOf() noexcept
+    {
+        using Reference = std::ranges::range_reference_t<Range>;
+        using Element = std::remove_reference_t<Reference>;
+        /// Контейнер-rvalue владеет элементами, view - нет: элементы view принадлежат кому-то еще
+        constexpr bool owned = !std::is_lvalue_reference_v<Range> && !std::ranges::view<std::remove_cvref_t<Range>>;
+
+        if constexpr (std::is_const_v<Element>)
+            return Transfer::ConstCopy;
+        else if constexpr (!std::is_lvalue_reference_v<Reference> || owned)
+            return Transfer::Move;
+        else
+            return Transfer::Copy;
+    }
+
+    namespace detail
+    {
+        template<class Container>
+        concept Reservable = requires(Container& container, std::size_t size)
+        {
+            container.reserve(size);
+            { container.capacity() } -> std::convertible_to<std::size_t>;
+        };
+    }
+
+    /*
+     Добавляет элементы range в конец container, expected - число элементов, если диапазон не знает своего размера.
+     reserve вызывается один раз до первого emplace_back, если у контейнера есть reserve и места не хватает:
+     емкость растет геометрически (не меньше удвоенной), как у emplace_back, иначе повторные Append малыми диапазонами
+     перевыделяли бы и перемещали весь контейнер каждый раз - квадратичное время.
+     */
+    template<Policy Check = Policy::Report, class Container, std::ranges::input_range Range>
+    Report Append(Container& container, Range&& range, std::size_t expected = 0)
+    {
+        constexpr Transfer transfer = TransferOf<Range>();
+        static_assert(Check != Policy::Reject || transfer != Transfer::ConstCopy,
+                      "INGEST::Append: const source elements are copied, not moved");
+
+        if constexpr (detail::Reservable<Container>)
+        {
+            std::size_t count = expected;
+            if constexpr (std::ranges::sized_range<Range>)
+                count = static_cast<std::size_t>(std::ranges::size(range));
+            const std::size_t required = container.size() + count;
+            if (required > container.capacity())
+                container.reserve(std::max<std::size_t>(required, container.capacity() * 2));
+        }
+
+        Report report;
+        std::size_t& counter = transfer == Transfer::Move ? report.moved : report.copied;
+        auto it = std::ranges::begin(range);
+        const auto end = std::ranges::end(range);
+        for (; it != end; ++it)
+        {
+            if constexpr (transfer == Transfer::Move)
+                container.emplace_back(std::ranges::iter_move(it));
+            else
+                container.emplace_back(*it);
+            ++counter;
+        }
+        return report;
+    }
+}
+
+#endif /* ingest_h */
@@ -0,0 +1,204 @@
+#ifndef invoke_h
+#define invoke_h
+
+#include "forward.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ Отложенный вызов (задача для пула потоков) с идеальной передачей: FORWARD::Function вызывает функцию сразу,
+ INVOKE::Defer сохраняет функцию и аргументы с их категориями значения и вызывает позже, ровно один раз.
+ - rvalue перемещается в задачу и при вызове передается как rvalue (std::move): функция, принимающая по значению, получает перемещение.
+ - lvalue по политике Capture::Copy копируется в задачу (задача не зависит от времени жизни аргумента),
+   по политике Capture::Reference сохраняется ссылка (аргумент должен жить до вызова). При вызове передается как lvalue.
+ Функция и аргументы хранятся в буфере задачи (small buffer optimization), если помещаются в Capacity байт и перемещаются без исключений,
+ иначе - в куче. std::function копируемый и хранит в буфере только указатели (16 байт в libstdc++), std::bind передает все аргументы как lvalue.
+ Вызов - только для rvalue задачи: std::move(task)(), после вызова задача пуста.
+ auto task = INVOKE::Defer([](Derived derived) { ... }, std::move(derived)); // Перемещение в задачу
+ std::move(task)(); // Перемещение в параметр derived
+ */
+namespace INVOKE
+{
+    enum class Capture
+    {
+        Copy,     // lvalue копируется в задачу
+        Reference // lvalue хранится по ссылке
+    };
+
+    /// Размер буфера задачи по умолчанию: Derived с функцией без состояния помещается без выделения памяти
+    inline constexpr std::size_t CAPACITY = 64;
+
+    namespace detail
+    {
+        /// Как аргумент хранится в задаче: ссылка или значение без const
+        template<Capture Policy, class Arg>
+        using Stored = std::conditional_t<std::is_lvalue_reference_v<Arg> && Policy == Capture::Reference, Arg, std::decay_t<Arg>>;
+
+        /// Функция и аргументы одной задачи
+        template<Capture Policy, class Function, class... Args>
+        struct Bundle
+        {
+            template<class F, class... As>
+            explicit Bundle(F&& function, As&&... args) :
+            function(FORWARD::forward<F>(function)),
+            args(FORWARD::forward<As>(args)...)
+            {}
+
+            /// Каждый аргумент передается со своей исходной категорией: Args - T& (lvalue) или T (rvalue)
+            decltype(auto) operator()()
+            {
+                return std::apply([this](auto&... stored) -> decltype(auto)
+                                  {
+                                      return std::invoke(std::move(function), static_cast<Args&&>(stored)...);
+                                  }, args);
+            }
+
+            std::decay_t<Function> function;
+            std::tuple<Stored<Policy, Args>...> args;
+        };
+
+        template<class R>
+        struct Operations
+        {
+            R (*invoke)(void* storage);
+            void (*move)(void* from, void* to) noexcept; // Перемещение в пустое хранилище to, from остается пустым
+            void (*destroy)(void* storage) noexcept;     // nullptr - деструктор тривиальный, вызов не нужен
+        };
+
+        /// Bundle в буфере задачи
+        template<class R, class Bundle>
+        struct Inline
+        {
+            static Bundle* Get(void* storage) noexcept { return std::launder(static_cast<Bundle*>(storage)); }
+
+            static R Invoke(void* storage) { return (*Get(storage))(); }
+
+            static void Move(void* from, void* to) noexcept
+            {
+                ::new (to) Bundle(std::move(*Get(from)));
+                Get(from)->~Bundle();
+            }
+
+            static void Destroy(void* storage) noexcept { Get(storage)->~Bundle(); }
+
+            static constexpr Operations<R> operations{Invoke, Move, std::is_trivially_destructible_v<Bundle> ? nullptr : Destroy};
+        };
+
+        /// Bundle в куче, в буфере задачи - указатель
+        template<class R, class Bundle>
+        struct Heap
+        {
+            static Bundle*& Get(void* storage) noexcept { return *std::launder(static_cast<Bundle**>(storage)); }
+
+            static R Invoke(void* storage) { return (*Get(storage))(); }
+
+            static void Move(void* from, void* to) noexcept
+            {
+                ::new (to) Bundle*(Get(from));
+            }
+
+            static void Destroy(void* storage) noexcept { delete Get(storage); }
+
+            static constexpr Operations<R> operations{Invoke, Move, Destroy};
+        };
+    }
+
+    /// Задача без копирования: только перемещение, вызов один раз
+    template<class R = void, std::size_t Capacity = CAPACITY>
+    class Task
+    {
+        static_assert(Capacity >= sizeof(void*), "INVOKE::Task buffer must hold at least a pointer");
+
+    public:
+        Task() noexcept = default;
+
+        template<Capture Policy, class Function, class... Args>
+        Task(std::integral_constant<Capture, Policy>, Function&& function, Args&&... args)
+        {
+            using Bundle = detail::Bundle<Policy, Function, Args...>;
+            static_assert(std::is_convertible_v<std::invoke_result_t<Bundle&>, R> || std::is_void_v<R>, "INVOKE::Task result is not convertible to R");
+
+            if constexpr (Inline<Bundle>)
+            {
+                ::new (static_cast<void*>(_storage)) Bundle(FORWARD::forward<Function>(function), FORWARD::forward<Args>(args)...);
+                _operations = &detail::Inline<R, Bundle>::operations;
+            }
+            else
+            {
+                ::new (static_cast<void*>(_storage)) Bundle*(new Bundle(FORWARD::forward<Function>(function), FORWARD::forward<Args>(args)...));
+                _operations = &detail::Heap<R, Bundle>::operations;
+            }
+        }
+
+        Task(Task&& other) noexcept :
+        _operations(std::exchange(other._operations, nullptr))
+        {
+            if (_operations)
+                _operations->move(other._storage, _storage);
+        }
+
+        // Возвращаем ссылку, чтобы потом можно было присвоить
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                _operations = std::exchange(other._operations, nullptr);
+                if (_operations)
+                    _operations->move(other._storage, _storage);
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task()
+        {
+            Reset();
+        }
+
+        /// Аргументы передаются ровно один раз, после вызова задача пуста (в том числе если функция бросила исключение)
+        R operator()() &&
+        {
+            struct Guard
+            {
+                ~Guard() { task.Reset(); }
+                Task& task;
+            } guard{*this};
+            return _operations->invoke(_storage);
+        }
+
+        explicit operator bool() const noexcept { return _operations; }
+
+        /// Функция с аргументами помещается в буфер задачи без выделения памяти
+        template<class Bundle>
+        static constexpr bool Inline = sizeof(Bundle) <= Capacity && alignof(Bundle) <= alignof(std::max_align_t) &&
+                                       std::is_nothrow_move_constructible_v<Bundle>;
+
+    private:
+        void Reset() noexcept
+        {
+            if (const detail::Operations<R>* operations = std::exchange(_operations, nullptr); operations && operations->destroy)
+                operations->destroy(_storage);
+        }
+
+        const detail::Operations<R>* _operations = nullptr;
+        alignas(std::max_align_t) unsigned char _storage[Capacity];
+    };
+
+    /// Задача из функции и аргументов, R - результат функции
+    template<Capture Policy = Capture::Copy, std::size_t Capacity = CAPACITY, class Function, class... Args>
+    auto Defer(Function&& function, Args&&... args)
+    {
+        using R = std::invoke_result_t<detail::Bundle<Policy, Function, Args...>&>;
+        return Task<R, Capacity>(std::integral_constant<Capture, Policy>{}, FORWARD::forward<Function>(function), FORWARD::forward<Args>(args)...);
+    }
+}
+
+#endif /* invoke_h */
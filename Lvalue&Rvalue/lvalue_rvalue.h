@@ -1,7 +1,16 @@
 #ifndef lvalue_rvalue_h
 #define lvalue_rvalue_h
 
+#include "relocate.h"
+#include "trace.h"
+
+#include <cstddef>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /*
  lvalue_rvalue
@@ -44,34 +53,75 @@
  };
  */
 
-template <typename T>
-void log(const T& object, const std::string& msg)
-{
-    std::cout << "[" << object << "] " << msg << "\n";
-}
-
 namespace lvalue_rvalue
 {
     namespace priority
     {
-        void function(int&& value)
+        /// Тип параметра выбранной перегрузки: decltype(function(x)) показывает результат разрешения перегрузки без вызова
+        template<class T>
+        struct Binding
         {
-            std::cout << "&&" << std::endl;
+            using type = T;
+        };
+
+        /// Название перегрузки по типу параметра: "&&", "const &&", "&", "const &"
+        template<class T>
+        constexpr const char* Name(Binding<T>) noexcept
+        {
+            constexpr bool constant = std::is_const_v<std::remove_reference_t<T>>;
+            if constexpr (std::is_lvalue_reference_v<T>)
+                return constant ? "const &" : "&";
+            else
+                return constant ? "const &&" : "&&";
         }
-        
-        void function(const int&& value)
+
+        /*
+         Что перегрузка делает с аргументом - политика Output, параметр шаблона function<Output>(value):
+         - Print - выводит название перегрузки (по умолчанию, демонстрация);
+         - Silent - без ввода-вывода и без доступа к аргументу: остается только выбор перегрузки, который полностью встраивается.
+         Аргумент передается в Output::Bind с категорией выбранной перегрузки: && и const && - rvalue, & и const & - lvalue.
+         */
+        struct Print
         {
-            std::cout << "const &&" << std::endl;
+            template<class Bound, class Value>
+            static void Bind(Value&&)
+            {
+                std::cout << Name(Bound{}) << '\n';
+            }
+        };
+
+        struct Silent
+        {
+            template<class Bound, class Value>
+            static void Bind(Value&&) noexcept {}
+        };
+
+        template<class Output = Print, class T>
+        Binding<T&&> function(T&& value)
+        {
+            Output::template Bind<Binding<T&&>>(std::move(value));
+            return {};
         }
-        
-        void function(int& value)
+
+        template<class Output = Print, class T>
+        Binding<const T&&> function(const T&& value)
+        {
+            Output::template Bind<Binding<const T&&>>(std::move(value));
+            return {};
+        }
+
+        template<class Output = Print, class T>
+        Binding<T&> function(T& value)
         {
-            std::cout << "&" << std::endl;
+            Output::template Bind<Binding<T&>>(value);
+            return {};
         }
 
-        void function(const int& value)
+        template<class Output = Print, class T>
+        Binding<const T&> function(const T& value)
         {
-            std::cout << "const &" << std::endl;
+            Output::template Bind<Binding<const T&>>(value);
+            return {};
         }
 
         int function1()
@@ -83,73 +133,111 @@ namespace lvalue_rvalue
         {
             return 1;
         }
-    }
 
-    class Base
-    {
-    public:
-        Base() = default;
+        /*
+         Таблица приоритета перегрузки, проверяется при компиляции:
+         - function2() возвращает const int, но у prvalue скалярного типа const отбрасывается, поэтому 1. T&&, а не 2. const T&&.
+         - Именованная rvalue-ссылка (number1) - lvalue, поэтому 4. const T&, а не 2. const T&&.
+         - const T&& выбирается только для const xvalue: std::move(const объект) или const объект класса, возвращаемый по значению.
+         */
+        static_assert(std::is_same_v<decltype(function(1)), Binding<int&&>>);
+        static_assert(std::is_same_v<decltype(function(function1())), Binding<int&&>>);
+        static_assert(std::is_same_v<decltype(function(function2())), Binding<int&&>>);
+        static_assert(std::is_same_v<decltype(function(std::declval<int&&>())), Binding<int&&>>);       // std::move(number)
+        static_assert(std::is_same_v<decltype(function(std::declval<const int&&>())), Binding<const int&&>>); // std::move(constNumber)
+        static_assert(std::is_same_v<decltype(function(std::declval<int&>())), Binding<int&>>);         // number, rvalue-ссылка по имени
+        static_assert(std::is_same_v<decltype(function(std::declval<const int&>())), Binding<const int&>>); // constNumber, const rvalue-ссылка по имени
 
-        ~Base()
-        {
-            
-        }
+        /*
+         Ожидаемая перегрузка выводится из категории значения выражения, а не перечисляется вручную:
+         decltype((expression)) - T& для lvalue, T&& для xvalue, T для prvalue; lvalue связывается с T& (const T&), xvalue и prvalue - с T&& (const T&&).
+         Check<Payloads...>() сравнивает Expected с фактическим выбором function для каждой категории каждого типа:
+         если компилятор разрешит перегрузку иначе, сборка остановится на static_assert.
+         */
+        template<class Expression>
+        using Expected = Binding<std::conditional_t<std::is_lvalue_reference_v<Expression>, Expression, std::remove_reference_t<Expression>&&>>;
 
-        Base(const Base& other)
-        {
-            
-        }
-        
-        Base& operator=(const Base& other) // Возвращаем ссылку, чтобы потом можно было присвоить
-        {
-            if (this == &other)
-                return *this;
-            
-            return *this;
-        }
-        
-        Base(Base&& other) noexcept
+        /// prvalue типа T для невычисляемого контекста (std::declval<T>() - xvalue)
+        template<class T>
+        T Prvalue() noexcept;
+
+        /// Категория значения аргумента: название и тип выражения decltype((expression))
+        template<class Payload>
+        struct Categories
         {
-            
-        }
-         
-        Base& operator=(Base&& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+            static constexpr const char* names[] = {"prvalue", "const prvalue", "xvalue", "const xvalue", "lvalue", "const lvalue"};
+            using Expressions = std::tuple<Payload, const Payload, Payload&&, const Payload&&, Payload&, const Payload&>;
+        };
+
+        /// Перегрузка, которую выбирает function(expression) для выражения типа decltype((expression))
+        template<class Expression>
+        using Actual = decltype(function<Silent>(Prvalue<Expression>()));
+
+        template<class Expressions, class = std::make_index_sequence<std::tuple_size_v<Expressions>>>
+        inline constexpr bool matches = false;
+
+        template<class Expressions, std::size_t... Indices>
+        inline constexpr bool matches<Expressions, std::index_sequence<Indices...>> =
+            (std::is_same_v<Actual<std::tuple_element_t<Indices, Expressions>>,
+                            Expected<decltype(Prvalue<std::tuple_element_t<Indices, Expressions>>())>> && ...);
+
+        template<class... Payloads>
+        constexpr bool Check() noexcept
         {
-            if (this == &other)
-                return *this;
-            
-            return *this;
+            return (matches<typename Categories<Payloads>::Expressions> && ...);
         }
+
+        static_assert(Check<int, std::string>());
+    }
+
+    /// Base без состояния: все специальные функции-члены тривиальные и noexcept, поэтому Derived не платит за базовый класс ни при копировании, ни при перемещении
+    class Base
+    {
+    public:
+        Base() = default;
+        ~Base() = default;
+        Base(const Base& other) = default;
+        Base& operator=(const Base& other) = default; // Возвращаем ссылку, чтобы потом можно было присвоить
+        Base(Base&& other) noexcept = default;
+        Base& operator=(Base&& other) noexcept = default; // Возвращаем ссылку, чтобы потом можно было присвоить
     };
 
-    class Derived : public Base
+    /*
+     Text - способ хранения текста (payload.h): std::string, PAYLOAD::InlineString<N>, PAYLOAD::SmallString<N>, PAYLOAD::InternedString.
+     Text должен создаваться из const char* и перемещаться без исключений.
+     */
+    template<class Text = std::string>
+    class BasicDerived : public Base
     {
+        static_assert(std::is_nothrow_move_constructible_v<Text> && std::is_nothrow_move_assignable_v<Text>,
+                      "BasicDerived requires noexcept move of Text");
+
     public:
-        Derived() : Base()
+        BasicDerived() : Base()
         {
-            log(this, "constructor");
+            TRACE::Trace(this, TRACE::Event::Constructor);
         }
 
-        ~Derived()
+        ~BasicDerived()
         {
-            log(this, "destructor");
+            TRACE::Trace(this, TRACE::Event::Destructor);
         }
 
-        Derived(const Derived& other)
         /*
-         Можно вызвать оператор присваивания, чтобы не писать лишний код
-         Base(other)
-         _number(other._number),
-         _text(other._text)
+         Конструктор копирования инициализирует поля поэлементно, а не через оператор присваивания:
+         *this = other; // Сначала создается _text = "text", потом перезаписывается
          */
+        BasicDerived(const BasicDerived& other) :
+        Base(other),
+        _number(other._number),
+        _text(other._text)
         {
-            log(this, "copy constructor");
-            *this = other;
+            TRACE::Trace(this, TRACE::Event::CopyConstructor);
         }
         
-        Derived& operator=(const Derived& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        BasicDerived& operator=(const BasicDerived& other) // Возвращаем ссылку, чтобы потом можно было присвоить
         {
-            log(this, "copy operator=");
+            TRACE::Trace(this, TRACE::Event::CopyAssignment);
             if (this == &other)
                 return *this;
             
@@ -159,21 +247,22 @@ namespace lvalue_rvalue
             return *this;
         }
         
-        Derived(Derived&& other) noexcept
         /*
-         Можно вызвать оператор присваивания, чтобы не писать лишний код
-         Base(std::move(other))
-         _number(std::move(other._number)),
-         _text(std::move(other._text))
+         Конструктор перемещения инициализирует поля поэлементно, а не через оператор присваивания:
+         *this = std::move(other); // Сначала создается _text = "text", потом перезаписывается
+         Перемещение std::string не выделяет память, поэтому конструктор noexcept и std::vector при росте перемещает элементы, а не копирует.
          */
+        BasicDerived(BasicDerived&& other) noexcept :
+        Base(std::move(other)),
+        _number(std::exchange(other._number, 0)),
+        _text(std::move(other._text))
         {
-            log(this, "move constructor");
-            *this = std::move(other);
+            TRACE::Trace(this, TRACE::Event::MoveConstructor);
         }
          
-        Derived& operator=(Derived&& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        BasicDerived& operator=(BasicDerived&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
         {
-            log(this, "move operator=");
+            TRACE::Trace(this, TRACE::Event::MoveAssignment);
             if (this == &other)
                 return *this;
             
@@ -183,49 +272,131 @@ namespace lvalue_rvalue
             return *this;
         }
         
+        /*
+         Полный набор ref-qualified перегрузок:
+         & и const & - ссылка на поле, объект продолжает жить.
+         && - объект временный (или std::move(derived)), поле перемещается в возвращаемое значение без копирования.
+         const && - из const объекта переместить нельзя, поэтому копия.
+         Derived().GetText(); // && - перемещение, память под строку не выделяется
+         */
+        /// Вызывается для неконстантного lvalue объекта
+        int& GetNumber() & noexcept
+        {
+            TRACE::Message("lvalue GetNumber");
+            return _number;
+        }
         /// Вызывается для lvalue объекта, тоже самое const int& GetNumber() const
         const int& GetNumber() const & noexcept
         {
-            std::cout << "lvalue GetNumber" << std::endl;
+            TRACE::Message("const lvalue GetNumber");
+            return _number;
+        }
+        /// Вызывается для rvalue объекта
+        int GetNumber() && noexcept
+        {
+            TRACE::Message("rvalue GetNumber");
             return _number;
         }
-        /// Вызывается для rvalue объекта, тоже самое int GetNumber() const
+        /// Вызывается для const rvalue объекта, тоже самое int GetNumber() const
         int GetNumber() const && noexcept
         {
-            std::cout << "rvalue GetNumber" << std::endl;
+            TRACE::Message("const rvalue GetNumber");
             return _number;
         }
-        /// Вызывается для lvalue объекта, тоже самое const std::string& GetText() const noexcept
-        const std::string& GetText() const & noexcept
+        /// Вызывается для неконстантного lvalue объекта
+        Text& GetText() & noexcept
         {
-            std::cout << "lvalue GetText" << std::endl;
+            TRACE::Message("lvalue GetText");
             return _text;
         }
-        /// Вызывается для rvalue объекта, тоже самое std::string GetText() const
-        std::string GetText() const && noexcept
+        /// Вызывается для lvalue объекта, тоже самое const Text& GetText() const noexcept
+        const Text& GetText() const & noexcept
         {
-            std::cout << "rvalue GetText" << std::endl;
+            TRACE::Message("const lvalue GetText");
             return _text;
         }
+        /// Вызывается для rvalue объекта, строка перемещается
+        Text GetText() && noexcept
+        {
+            TRACE::Message("rvalue GetText");
+            return std::move(_text);
+        }
+        /// Вызывается для const rvalue объекта, строка копируется
+        Text GetText() const &&
+        {
+            TRACE::Message("const rvalue GetText");
+            return _text;
+        }
+
+        /*
+         Извлечение поля: только для rvalue, для lvalue нужно явно std::move(derived).ExtractText().
+         После извлечения поле в исходном состоянии по умолчанию (_number = 0, _text пустая), как после перемещения.
+         */
+        int ExtractNumber() && noexcept
+        {
+            return std::exchange(_number, 0);
+        }
+        Text ExtractText() && noexcept
+        {
+            return std::exchange(_text, {});
+        }
+
+        /*
+         Builder: для lvalue возвращается Derived&, для rvalue - Derived&&, поэтому цепочка на временном объекте остается rvalue
+         и заканчивается перемещением, а не копированием:
+         std::string text = Derived().SetText(std::move(text)).SetNumber(7).GetText(); // Выделяется память только под исходную строку
+         */
+        BasicDerived& SetNumber(int number) & noexcept
+        {
+            _number = number;
+            return *this;
+        }
+        BasicDerived&& SetNumber(int number) && noexcept
+        {
+            _number = number;
+            return std::move(*this);
+        }
+        BasicDerived& SetText(Text text) & noexcept
+        {
+            _text = std::move(text);
+            return *this;
+        }
+        BasicDerived&& SetText(Text text) && noexcept
+        {
+            _text = std::move(text);
+            return std::move(*this);
+        }
         
         int _number = 5;
-        std::string _text = "text";
+        Text _text = "text";
     };
 
-    /// Вызывается обычный конструктор без копирования и без перемещения, нет смысла вызывать std::move для rvalue, т.к объект из стека удаляется
+    using Derived = BasicDerived<>;
+
+    static_assert(std::is_trivially_copyable_v<Base>);
+    static_assert(std::is_nothrow_default_constructible_v<Base>);
+    static_assert(std::is_nothrow_copy_constructible_v<Base>);
+    static_assert(std::is_nothrow_move_constructible_v<Derived>);
+    static_assert(std::is_nothrow_move_assignable_v<Derived>);
+    static_assert(std::is_nothrow_destructible_v<Derived>);
+    static_assert(std::is_nothrow_swappable_v<Derived>);
+    static_assert(RELOCATE::is_trivially_relocatable_v<Base>);
+    static_assert(priority::Check<Derived, std::vector<int>, std::vector<Derived>>());
+
+    /// Вызывается обычный конструктор без копирования и без перемещения (NRVO, с -fno-elide-constructors - перемещение), нет смысла вызывать std::move для rvalue, т.к объект из стека удаляется
     Derived getDerived1()
     {
         Derived derived = Derived();
         return derived;
     }
 
-    /// Вызывается обычный конструктор без копирования и без перемещения, нет смысла вызывать std::move для rvalue
+    /// Вызывается обычный конструктор без копирования и без перемещения (гарантированный пропуск с C++17 при любых флагах), нет смысла вызывать std::move для rvalue
     Derived getDerived2()
     {
         return Derived();
     }
 
-    /// Вызовется конструктор копирования вместо operator= перемещения, потому что создается новый объект и он стоит слева(lvalue), нет смысла вызывать std::move для rvalue
+    /// Вызовется конструктор перемещения вместо operator= перемещения, потому что создается новый объект и он стоит слева(lvalue), нет смысла вызывать std::move для rvalue
     Derived getDerived;
     Derived&& getDerived3()
     {
@@ -233,4 +404,8 @@ namespace lvalue_rvalue
     }
 }
 
+/// BasicDerived - это int и Text, поэтому тривиально релоцируем, если релоцируем Text
+template<class Text>
+struct RELOCATE::is_trivially_relocatable<lvalue_rvalue::BasicDerived<Text>> : RELOCATE::is_trivially_relocatable<Text> {};
+
 #endif /* lvalue_rvalue_h */
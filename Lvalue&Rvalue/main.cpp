@@ -1,6 +1,23 @@
+#define ALLOCATION_REPLACE_NEW // Учет выделений памяти по областям SCOPE
+
+#include "allocation.h"
+#include "cow.h"
 #include "forward.h"
+#include "generator.h"
+#include "ingest.h"
+#include "invoke.h"
+#include "pmr.h"
+#include "pool.h"
+#include "queue.h"
+#include "serialize.h"
+#include "soa.h"
 #include "swap.h"
 
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <ranges>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -72,10 +89,13 @@ int main()
             const int number3 = 1;
             
             function(function1()); //  1. T&& (rvalue)
-            function(function2()); // 1. T&& (rvalue) вместо 2. const T&& (rvalue) TODO: непонятно
-            function(number1); // 4. const T& (lvalue) вместо 2. const T&& (rvalue) TODO: непонятно
+            function(function2()); // 1. T&& (rvalue) вместо 2. const T&& (rvalue): у prvalue типа int const отбрасывается
+            function(number1); // 4. const T& (lvalue) вместо 2. const T&& (rvalue): именованная rvalue-ссылка - это lvalue
             function(number2); // 3. T& (lvalue)
             function(number3); // 4. const T& (lvalue)
+            function(std::move(getDerived)); // 1. T&& (rvalue): перегрузки - шаблоны, таблица та же для любого типа
+            function(std::move(std::as_const(getDerived))); // 2. const T&& (const rvalue)
+            function<Silent>(number2); // 3. T& без вывода
         }
         // Derived& derivedRef1 = getDerived1(); // Не скомпилируется - нельзя привязать rvalue к ссылке на lvalue
         const Derived& derivedRef2 = getDerived1();
@@ -83,6 +103,10 @@ int main()
         // Derived&& derivedRef4 = derivedRef3; // Не скомпилируется - нельзя привязать rvalue к ссылке на lvalue
         [[maybe_unused]] Derived&& derivedRef5 = std::move(derivedRef3); // Требуется вызвать std::move для xvalue, которое имеет свойства rvalue и lvalue (в приоритете)
         Derived derivedRef6 = std::move(derivedRef2); // Вызывается конструктор копирования для const обекта, нет смысла вызывать std::move
+        /// COW: копия const объекта тоже вызывает конструктор копирования, но _text - общий блок, текст не копируется
+        const COW::Derived cowDerived;
+        COW::Derived cowCopy = std::move(cowDerived);
+        std::cout << "cow use_count: " << cowCopy._text.use_count() << std::endl; // 2
         
         /// Вызывается обычный конструктор без копирования и без перемещения, нет смысла вызывать std::move
         Derived derived1 = getDerived1();
@@ -111,6 +135,10 @@ int main()
         std::unique_ptr<Derived> derived7 = std::make_unique<Derived>();
         /// Есть конструктор перемещения у умных указателей, есть смысл вызвать std::move для lvalue
         std::unique_ptr<Derived> derived8 = std::move(derived7);
+        /// Передача владения через очередь между потоками: только перемещение, ring.push(derived8) не скомпилируется
+        QUEUE::Ring<std::unique_ptr<Derived>> ring(2);
+        ring.push(std::move(derived8));
+        std::thread([&ring] { std::unique_ptr<Derived> derived9; ring.try_pop(derived9); }).join();
         
         std::vector<Derived> deriveds;
         /// Вызывается  конструктор перемещения, есть смысл вызывать std::move для lvalue (reserve(1))
@@ -119,13 +147,77 @@ int main()
         deriveds.emplace_back(std::move(derived4));
         /// Вызов конструктора копирования для const объекта (reserve(4))
         deriveds.emplace_back(std::move(derivedRef2));
+        /// Пакетная загрузка: один reserve, перемещение из контейнера-rvalue, копирование const источника попадает в отчет
+        {
+            std::vector<Derived> batch(2);
+            const INGEST::Report moved = INGEST::Append(deriveds, std::move(batch)); // 2 конструктора перемещения (и перенос старых элементов при reserve)
+            const std::vector<Derived> constBatch(1);
+            const INGEST::Report copied = INGEST::Append(deriveds, std::ranges::subrange(std::make_move_iterator(constBatch.begin()), std::make_move_iterator(constBatch.end())));
+            // INGEST::Append<INGEST::Policy::Reject>(deriveds, constBatch); // Не скомпилируется - const источник копируется
+            std::cout << "moved: " << moved.moved << ", copied: " << copied.copied << std::endl; // moved: 2, copied: 1
+        }
+        /// Таблица по столбцам: строки перемещаются целиком, проход читает только столбец _number
+        {
+            SOA::Vector<> table;
+            table.push_back(std::move(deriveds.back())); // Перемещение полей в столбцы, без конструкторов Derived
+            table.push_back(std::as_const(deriveds.front())); // Копирование полей
+            [[maybe_unused]] int& number = table[0].GetNumber(); // Как Derived&
+            [[maybe_unused]] std::string text = std::move(table)[1].GetText(); // Как Derived&&: строка перемещается из столбца
+            std::cout << "soa sum: " << SOA::Sum(table.numbers()) << std::endl;
+        }
+        /// Запись перемещением в двоичный файл и чтение через отображение в память без создания строк
+        {
+            const std::string path = (std::filesystem::temp_directory_path() / "lvalue_rvalue_main.bin").string();
+            {
+                SERIALIZE::Writer writer(path);
+                writer.Write(Derived().SetNumber(7).SetText("serialized")); // Только rvalue: writer.Write(derived) не скомпилируется
+                writer.Close();
+            }
+            const SERIALIZE::View view(path);
+            const std::string_view text = view[0].GetText(); // Указатель в отображение файла
+            std::cout << "serialized: " << view[0].GetNumber() << ' ' << text << std::endl;
+            std::filesystem::remove(path);
+        }
+        /// Пул: объект после перемещения из него возвращается в пул и выдается снова с емкостью строки
+        {
+            const char* buffer = nullptr;
+            {
+                POOL::Handle<Derived> pooled = POOL::Pool<Derived>::Acquire();
+                pooled->_text.assign(64, 'p');
+                buffer = pooled->_text.data();
+            } // Возврат в пул: _number = 0, _text.clear()
+            POOL::Handle<Derived> reused = POOL::Pool<Derived>::Acquire();
+            reused->_text.assign(32, 'r'); // Без выделения памяти
+            std::cout << "pool reused: " << std::boolalpha << (reused->_text.data() == buffer) << std::noboolalpha << std::endl; // true
+        }
+        /// Конвейер на сопрограммах: объекты идут от стадии к стадии только перемещением
+        {
+            const auto source = [](int count) -> GENERATOR::Generator<Derived> // Лямбда без захвата: кадр сопрограммы не ссылается на лямбду
+            {
+                for (int i = 0; i < count; ++i)
+                    co_yield Derived().SetNumber(i); // rvalue, co_yield derived не скомпилируется
+            };
+            std::size_t count = 0;
+            for (std::vector<Derived>&& batch : source(5) | GENERATOR::Filter([](const Derived& derived) { return derived._number % 2 == 0; })
+                                                          | GENERATOR::Batch(2))
+                count += batch.size();
+            std::cout << "generator: " << count << std::endl; // 3: 0, 2, 4
+        }
         
         Derived derived;
         [[maybe_unused]] const int& numberLvalue = derived.GetNumber();
         [[maybe_unused]] const std::string& textLvalue = derived.GetText();
         
+        const Derived constDerived;
+        [[maybe_unused]] const int& numberConstLvalue = constDerived.GetNumber();
+        [[maybe_unused]] const std::string& textConstLvalue = constDerived.GetText();
+        
         [[maybe_unused]] const int& numberRvalue = Derived().GetNumber();
-        [[maybe_unused]] const std::string& textRvalue = Derived().GetText();
+        [[maybe_unused]] const std::string& textRvalue = Derived().GetText(); // Перемещение строки
+        [[maybe_unused]] std::string textConstRvalue = std::move(constDerived).GetText(); // Копирование строки
+        
+        [[maybe_unused]] std::string textExtract = std::move(derived).ExtractText(); // derived._text пустая
+        [[maybe_unused]] std::string textBuilder = Derived().SetText("builder").SetNumber(7).GetText(); // Цепочка на rvalue, строка перемещается
         
         std::cout << "--------------------" << std::endl;
         
@@ -142,12 +234,12 @@ int main()
      Отличие std::move от std::forward: std::move - приводит lvalue к rvalue, std::forward - lvalue просто возвращает lvalue, а rvalue – возвращает std::move(rvalue).
      */
     {
-        using namespace MOVE;
+        // MOVE::move с квалификацией: Derived = BasicDerived<std::string>, и ADL по аргументу шаблона находит еще и std::move
         lvalue_rvalue::Derived derived = lvalue_rvalue::getDerived1();
-        derived = move(derived); // Вызывается operator= перемещения, но нет смысла вызывать std::move для перемещения объекта в самого себя
-        lvalue_rvalue::Derived derived2(move(derived)); // Вызывается конструктор перемещения, есть смысл вызывать std::move для lvalue
-        const lvalue_rvalue::Derived derived3 = move(derived2); // Вызывается конструктор перемещения, есть смысл вызывать std::move для lvalue
-        lvalue_rvalue::Derived derived4 = move(derived3); // Вызывается конструктор копирования для const обекта, нет смысла вызывать std::move
+        derived = MOVE::move(derived); // Вызывается operator= перемещения, но нет смысла вызывать std::move для перемещения объекта в самого себя
+        lvalue_rvalue::Derived derived2(MOVE::move(derived)); // Вызывается конструктор перемещения, есть смысл вызывать std::move для lvalue
+        const lvalue_rvalue::Derived derived3 = MOVE::move(derived2); // Вызывается конструктор перемещения, есть смысл вызывать std::move для lvalue
+        lvalue_rvalue::Derived derived4 = MOVE::move(derived3); // Вызывается конструктор копирования для const обекта, нет смысла вызывать std::move
     }
     /*
      std::swap - меняет местами два параметра одинаковых типа, используя до C++11 оператор копирования копирования, после C++11 оператор перемещения (std::move).
@@ -173,9 +265,12 @@ int main()
         
         std::string str1 = "str1", str2 = "str2";
         int number1 = 1, number2 = 2;
+        int numbers1[4] = {1, 2, 3, 4}, numbers2[4] = {5, 6, 7, 8};
         swap_old(str1, str2); // До С++11: семантика копирования
-        swap(str1, str2); // После С++11: семантика перемещения
-        swap(number1, number2); // Для int вызовется копирование, т.к.e у int нет конструктора перемещения
+        swap_move(str1, str2); // После С++11: семантика перемещения
+        SWAP::swap(str1, str2); // Функция-член std::string::swap, без временного объекта (без SWAP:: по ADL выберется более специализированный std::swap)
+        swap(number1, number2); // Побайтовый обмен, т.к. int тривиально копируемый (у int нет конструктора перемещения)
+        swap(numbers1, numbers2); // Массив обменивается одним блоком байт
     }
     
     /*
@@ -229,6 +324,17 @@ int main()
         Function(0); // rvalue: T - int, arg - int&&, std::cout << "&" << "&&" << "&&" << std::endl;
         std::cout << "--------------------" << std::endl;
         
+        // Отложенный вызов: аргументы сохраняются со своей категорией значения и передаются при вызове задачи
+        {
+            std::cout << "DEFER" << std::endl;
+            const auto function = [](auto&& value) { return lvalue_rvalue::priority::function(FORWARD::forward<decltype(value)>(value)); };
+            auto lvalue = INVOKE::Defer<INVOKE::Capture::Reference>(function, number); // Ссылка на number
+            auto rvalue = INVOKE::Defer(function, 0);                                // Значение перемещено в задачу
+            std::move(lvalue)(); // std::cout << "&" << std::endl;
+            std::move(rvalue)(); // std::cout << "&&" << std::endl;
+            std::cout << "--------------------" << std::endl;
+        }
+        
         A a;
         std::cout << "--------------------" << std::endl;
         // Без std::forward
@@ -242,10 +348,76 @@ int main()
         // std::forward
         {
             std::cout << "FORWARD" << std::endl;
-            auto shared_ptr1 = Make_Shared_Forward<A>(a);   // Должно произойти перемещение
+            auto shared_ptr1 = Make_Shared_Forward<A>(a);   // Должно произойти копирование, т.к. a - lvalue
             auto shared_ptr2 = Make_Shared_Forward<A>(A()); // Должно произойти перемещение
             std::cout << "--------------------" << std::endl;
         }
+        
+        // Несколько аргументов, каждый со своей категорией значения
+        {
+            std::cout << "VARIADIC FORWARD" << std::endl;
+            const A constA;
+            auto shared_ptr = Make_Shared_Forward<std::pair<A, A>>(a, A());        // Копирование и перемещение
+            auto unique_ptr = Make_Unique<std::pair<A, A>>(constA, std::move(a)); // Копирование и перемещение
+            
+            std::byte buffer[1024];
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+            auto arena_ptr = Make_Shared_Arena<A>(&arena, A()); // Перемещение, память из buffer
+            std::cout << "--------------------" << std::endl;
+        }
+    }
+    
+    /*
+     PMR (polymorphic memory resource) - память берется из переданного std::pmr::memory_resource.
+     std::pmr::vector передает свой ресурс элементам, поэтому буфер вектора и строки _text лежат в одной арене.
+     */
+    {
+        std::cout << "PMR" << std::endl;
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::vector<PMR::Derived> deriveds(&arena);
+        deriveds.reserve(2);
+        deriveds.emplace_back("text in arena, longer than small string optimization"); // Конструктор с аллокатором вектора
+        deriveds.emplace_back(deriveds.front()); // Копирование в ресурс вектора
+        std::cout << "--------------------" << std::endl;
+    }
+    
+    /*
+     ALLOCATION - где копирование превращается в выделение памяти: строка _text длиннее SSO, блок управления std::shared_ptr, рост вектора.
+     Перемещение длинной строки не выделяет память - если выделило, демонстрация завершается с ошибкой (проверка в ctest).
+     */
+    {
+        using namespace lvalue_rvalue;
+        using namespace FORWARD;
+
+        std::cout << "ALLOCATION" << std::endl;
+        Derived derived;
+        derived.SetText(std::string(64, 't'));
+        {
+            SCOPE("getDerived1");
+            [[maybe_unused]] Derived derived1 = getDerived1();
+        }
+        {
+            SCOPE("copy long text");
+            [[maybe_unused]] Derived copy(derived);
+        }
+        {
+            SCOPE("move long text");
+            [[maybe_unused]] Derived moved(std::move(derived));
+        }
+        {
+            SCOPE("Make_Shared_Forward");
+            [[maybe_unused]] auto shared_ptr = Make_Shared_Forward<Derived>();
+        }
+        {
+            SCOPE("deriveds.emplace_back grow");
+            std::vector<Derived> deriveds;
+            for (int i = 0; i < 4; ++i)
+                deriveds.emplace_back();
+        }
+        ALLOCATION::Print(std::cout);
+        std::cout << "--------------------" << std::endl;
+        if (ALLOCATION::Get("move long text").count)
+            return EXIT_FAILURE;
     }
     
     return 0;
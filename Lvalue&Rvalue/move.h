@@ -1,6 +1,8 @@
 #ifndef move_h
 #define move_h
 
+#include <type_traits>
+
 /*
  std::move - НИЧЕГО НЕ ПЕРЕМЕЩАЕТ, преобразует неконстантную lvalue-ссылку или rvalue-ссылку в rvalue-ссылку. Это просто обертка для static_cast, которая убирает ссылку (& или &&) у переданного аргумента с помощью remove_reference_t и добавляет &&, чтобы преобразовать в тип rvalue.
  C помощью move можно попасть в конструктор перемещения или оператор присваивания, если он реализован в классе.
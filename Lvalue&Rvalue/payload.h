@@ -0,0 +1,225 @@
+#ifndef payload_h
+#define payload_h
+
+#include "relocate.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/*
+ Варианты хранения текста для lvalue_rvalue::BasicDerived<Text>:
+ - std::string - SSO до 15 символов (libstdc++), длиннее - динамическая память: копирование выделяет память, перемещение - нет.
+ - PAYLOAD::InlineString<Capacity> - буфер фиксированного размера внутри объекта: никогда не выделяет память,
+   тривиально копируемый, но копирование и перемещение всегда копируют Capacity байт.
+ - PAYLOAD::SmallString<Threshold> - SSO с настраиваемым порогом: до Threshold символов внутри объекта, длиннее - динамическая память.
+   Не хранит указатель на себя, поэтому тривиально релоцируем (в отличие от std::string в libstdc++).
+ - PAYLOAD::InternedString - неизменяемая строка из общего пула: объект - это только std::string_view,
+   копирование и перемещение не выделяют память и не копируют текст, одинаковые строки хранятся один раз.
+ lvalue_rvalue::BasicDerived<PAYLOAD::SmallString<64>> derived;
+ */
+namespace PAYLOAD
+{
+    /// Строка в буфере фиксированного размера, при превышении Capacity - std::length_error
+    template<std::size_t Capacity>
+    class InlineString
+    {
+    public:
+        InlineString() noexcept = default;
+
+        InlineString(std::string_view text) :
+        _size(text.size())
+        {
+            if (text.size() > Capacity)
+                throw std::length_error("PAYLOAD::InlineString capacity exceeded");
+            std::memcpy(_data.data(), text.data(), text.size());
+        }
+
+        InlineString(const char* text) :
+        InlineString(std::string_view(text))
+        {
+
+        }
+
+        const char* data() const noexcept { return _data.data(); }
+        std::size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+        static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        operator std::string_view() const noexcept { return {data(), _size}; }
+
+        friend bool operator==(const InlineString& lhs, const InlineString& rhs) noexcept
+        {
+            return std::string_view(lhs) == std::string_view(rhs);
+        }
+
+    private:
+        std::array<char, Capacity> _data;
+        std::size_t _size = 0;
+    };
+
+    /// SSO с порогом Threshold: текст до Threshold символов хранится внутри объекта
+    template<std::size_t Threshold = 15>
+    class SmallString
+    {
+        static_assert(Threshold > 0, "PAYLOAD::SmallString threshold must be positive");
+
+    public:
+        SmallString() noexcept = default;
+
+        SmallString(std::string_view text) :
+        _size(text.size())
+        {
+            if (!IsInline())
+                _storage.heap = new char[_size];
+            std::memcpy(data(), text.data(), _size);
+        }
+
+        SmallString(const char* text) :
+        SmallString(std::string_view(text))
+        {
+
+        }
+
+        ~SmallString()
+        {
+            if (!IsInline())
+                delete[] _storage.heap;
+        }
+
+        SmallString(const SmallString& other) :
+        SmallString(std::string_view(other))
+        {
+
+        }
+
+        SmallString& operator=(const SmallString& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            if (this == &other)
+                return *this;
+
+            SmallString copy(other);
+            swap(copy);
+            return *this;
+        }
+
+        /// Указатель на динамическую память или байты буфера переносятся как есть, other становится пустой строкой
+        SmallString(SmallString&& other) noexcept :
+        _size(std::exchange(other._size, 0)),
+        _storage(other._storage)
+        {
+
+        }
+
+        SmallString& operator=(SmallString&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            if (this == &other)
+                return *this;
+
+            SmallString moved(std::move(other));
+            swap(moved);
+            return *this;
+        }
+
+        void swap(SmallString& other) noexcept
+        {
+            std::swap(_size, other._size);
+            std::swap(_storage, other._storage);
+        }
+
+        char* data() noexcept { return IsInline() ? _storage.buffer : _storage.heap; }
+        const char* data() const noexcept { return IsInline() ? _storage.buffer : _storage.heap; }
+        std::size_t size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+        static constexpr std::size_t threshold() noexcept { return Threshold; }
+
+        operator std::string_view() const noexcept { return {data(), _size}; }
+
+        friend bool operator==(const SmallString& lhs, const SmallString& rhs) noexcept
+        {
+            return std::string_view(lhs) == std::string_view(rhs);
+        }
+
+    private:
+        bool IsInline() const noexcept { return _size <= Threshold; }
+
+        union Storage
+        {
+            char buffer[Threshold];
+            char* heap;
+        };
+
+        std::size_t _size = 0;
+        Storage _storage;
+    };
+
+    /// Неизменяемая строка из общего пула, строки пула не освобождаются до завершения программы
+    class InternedString
+    {
+    public:
+        InternedString() noexcept = default;
+
+        InternedString(std::string_view text) :
+        _text(Intern(text))
+        {
+
+        }
+
+        InternedString(const char* text) :
+        InternedString(std::string_view(text))
+        {
+
+        }
+
+        const char* data() const noexcept { return _text.data(); }
+        std::size_t size() const noexcept { return _text.size(); }
+        bool empty() const noexcept { return _text.empty(); }
+
+        operator std::string_view() const noexcept { return _text; }
+
+        /// Одинаковые строки лежат по одному адресу, поэтому сравнение - сравнение указателей
+        friend bool operator==(const InternedString& lhs, const InternedString& rhs) noexcept
+        {
+            return lhs._text.data() == rhs._text.data() && lhs._text.size() == rhs._text.size();
+        }
+
+    private:
+        static std::string_view Intern(std::string_view text)
+        {
+            if (text.empty())
+                return {};
+
+            // Пул без деструктора: строки доступны и во время уничтожения глобальных объектов
+            struct Pool
+            {
+                std::mutex mutex;
+                std::set<std::string, std::less<>> strings;
+            };
+            static Pool* pool = new Pool;
+
+            std::lock_guard lock(pool->mutex);
+            auto found = pool->strings.find(text);
+            if (found == pool->strings.end())
+                found = pool->strings.emplace(text).first;
+            return *found;
+        }
+
+        std::string_view _text;
+    };
+
+    static_assert(std::is_trivially_copyable_v<InlineString<8>>);
+    static_assert(std::is_nothrow_move_constructible_v<SmallString<>>);
+    static_assert(std::is_trivially_copyable_v<InternedString>);
+}
+
+template<std::size_t Threshold>
+struct RELOCATE::is_trivially_relocatable<PAYLOAD::SmallString<Threshold>> : std::true_type {};
+
+#endif /* payload_h */
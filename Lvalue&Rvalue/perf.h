@@ -0,0 +1,189 @@
+#ifndef perf_h
+#define perf_h
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ Аппаратные счетчики процессора через perf_event_open (только Linux): такты, инструкции, промахи L1 и последнего уровня кэша,
+ ошибки предсказания переходов, page faults.
+ Счетчики наследуются потоками, созданными после Start(), поэтому учитывают и рабочие потоки сценария.
+ Считается только пользовательский код (exclude_kernel), этого достаточно при /proc/sys/kernel/perf_event_paranoid <= 2.
+ Каждый счетчик открывается отдельно: если часть недоступна (виртуальная машина без PMU, запрет в контейнере, процессор без события),
+ остальные продолжают работать, например page faults - программное событие ядра и есть почти всегда.
+ Если счетчиков больше, чем аппаратных регистров, ядро включает их по очереди, значения масштабируются на долю времени работы.
+ Время (clock_gettime) есть всегда: монотонное и процессорное время процесса - замена счетчикам, когда они недоступны.
+ PERF::Counters counters;
+ counters.Start();
+ ... // Замеряемый код
+ PERF::Sample sample = counters.Stop();
+ if (sample.Valid(PERF::Event::Cycles)) sample[PERF::Event::Cycles];
+ */
+namespace PERF
+{
+    enum class Event : std::size_t
+    {
+        Cycles,          // Такты процессора
+        Instructions,    // Выполненные инструкции
+        L1Misses,        // Промахи чтения L1 кэша данных
+        CacheMisses,     // Промахи последнего уровня кэша (в том числе из-за false sharing - кэш-линия, которую пишут несколько ядер)
+        CacheReferences, // Обращения к последнему уровню кэша
+        BranchMisses,    // Ошибки предсказания переходов
+        PageFaults,      // Page faults (первое обращение к новой странице памяти)
+        Count
+    };
+
+    constexpr std::size_t EVENTS = static_cast<std::size_t>(Event::Count);
+
+    constexpr const char* Name(Event event) noexcept
+    {
+        switch (event)
+        {
+            case Event::Cycles:          return "cycles";
+            case Event::Instructions:    return "instructions";
+            case Event::L1Misses:        return "l1_misses";
+            case Event::CacheMisses:     return "cache_misses";
+            case Event::CacheReferences: return "cache_references";
+            case Event::BranchMisses:    return "branch_misses";
+            case Event::PageFaults:      return "page_faults";
+            default:                     return "unknown";
+        }
+    }
+
+    /// Значения счетчиков и время, недоступные счетчики - Valid(event) == false
+    struct Sample
+    {
+        std::uint64_t operator[](Event event) const noexcept { return values[static_cast<std::size_t>(event)]; }
+        bool Valid(Event event) const noexcept { return valid & (1u << static_cast<std::size_t>(event)); }
+
+        std::array<std::uint64_t, EVENTS> values{};
+        std::uint32_t valid = 0;        // Битовая маска доступных счетчиков
+        std::uint64_t nanoseconds = 0;    // CLOCK_MONOTONIC
+        std::uint64_t cpuNanoseconds = 0; // CLOCK_PROCESS_CPUTIME_ID - процессорное время всех потоков процесса
+    };
+
+    namespace detail
+    {
+        inline std::uint64_t Clock(clockid_t clock) noexcept
+        {
+            timespec time{};
+            clock_gettime(clock, &time);
+            return static_cast<std::uint64_t>(time.tv_sec) * 1000000000ull + static_cast<std::uint64_t>(time.tv_nsec);
+        }
+    }
+
+    class Counters
+    {
+    public:
+        Counters() noexcept
+        {
+            _descriptors.fill(-1);
+#if defined(__linux__)
+            constexpr std::uint64_t L1_READ_MISS = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            constexpr std::array<std::pair<std::uint32_t, std::uint64_t>, EVENTS> events =
+            {{
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HW_CACHE, L1_READ_MISS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+            }};
+            for (std::size_t i = 0; i < EVENTS; ++i)
+            {
+                perf_event_attr attribute{};
+                attribute.size = sizeof(attribute);
+                attribute.type = events[i].first;
+                attribute.config = events[i].second;
+                attribute.disabled = 1;
+                attribute.inherit = 1;
+                attribute.exclude_kernel = 1;
+                attribute.exclude_hv = 1;
+                attribute.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                _descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attribute, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        ~Counters()
+        {
+#if defined(__linux__)
+            for (int descriptor : _descriptors)
+            {
+                if (descriptor >= 0)
+                    close(descriptor);
+            }
+#endif
+        }
+
+        Counters(const Counters&) = delete;
+        Counters& operator=(const Counters&) = delete;
+
+        /// Хотя бы один счетчик доступен
+        bool Available() const noexcept
+        {
+            for (int descriptor : _descriptors)
+            {
+                if (descriptor >= 0)
+                    return true;
+            }
+            return false;
+        }
+
+        void Start() noexcept
+        {
+#if defined(__linux__)
+            for (int descriptor : _descriptors)
+            {
+                if (descriptor >= 0)
+                {
+                    ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+            _cpu = detail::Clock(CLOCK_PROCESS_CPUTIME_ID);
+            _start = detail::Clock(CLOCK_MONOTONIC);
+        }
+
+        Sample Stop() noexcept
+        {
+            Sample sample;
+            sample.nanoseconds = detail::Clock(CLOCK_MONOTONIC) - _start;
+            sample.cpuNanoseconds = detail::Clock(CLOCK_PROCESS_CPUTIME_ID) - _cpu;
+#if defined(__linux__)
+            for (std::size_t i = 0; i < EVENTS; ++i)
+            {
+                if (_descriptors[i] < 0)
+                    continue;
+
+                ioctl(_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+                std::uint64_t value[3] = {}; // Значение, время включения, время работы
+                if (read(_descriptors[i], value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)) || !value[2])
+                    continue;
+
+                sample.values[i] = value[2] < value[1] ? static_cast<std::uint64_t>(static_cast<double>(value[0]) * value[1] / value[2]) : value[0];
+                sample.valid |= 1u << i;
+            }
+#endif
+            return sample;
+        }
+
+    private:
+        std::array<int, EVENTS> _descriptors;
+        std::uint64_t _start = 0;
+        std::uint64_t _cpu = 0;
+    };
+}
+
+#endif /* perf_h */
@@ -0,0 +1,111 @@
+#ifndef pmr_h
+#define pmr_h
+
+#include "lvalue_rvalue.h"
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/*
+ PMR (polymorphic memory resource) - память берется не из глобального operator new, а из переданного std::pmr::memory_resource.
+ Ресурсы:
+ - std::pmr::new_delete_resource() - обычный operator new/delete (по умолчанию).
+ - std::pmr::monotonic_buffer_resource - арена: выделение - сдвиг указателя, освобождение - ничего не делает, вся память возвращается при уничтожении арены.
+ - std::pmr::unsynchronized_pool_resource - пулы блоков одинакового размера, освобожденные блоки переиспользуются.
+ Контейнер std::pmr::vector<T> передает свой ресурс элементам (uses-allocator construction), если у T есть allocator_type и конструкторы с аллокатором.
+ Поэтому и буфер вектора, и строки _text всех элементов лежат в одной арене:
+ std::pmr::monotonic_buffer_resource arena;
+ std::pmr::vector<PMR::Derived> deriveds(&arena);
+ deriveds.emplace_back("text"); // Derived("text", allocator вектора)
+ */
+namespace PMR
+{
+    class Derived : public lvalue_rvalue::Base
+    {
+    public:
+        using allocator_type = std::pmr::polymorphic_allocator<>;
+
+        explicit Derived(const allocator_type& allocator = {}) :
+        _text("text", allocator)
+        {
+            TRACE::Trace(this, TRACE::Event::Constructor);
+        }
+
+        Derived(std::string_view text, const allocator_type& allocator = {}) :
+        _text(text, allocator)
+        {
+            TRACE::Trace(this, TRACE::Event::Constructor);
+        }
+
+        ~Derived()
+        {
+            TRACE::Trace(this, TRACE::Event::Destructor);
+        }
+
+        Derived(const Derived& other, const allocator_type& allocator = {}) :
+        Base(other),
+        _number(other._number),
+        _text(other._text, allocator)
+        {
+            TRACE::Trace(this, TRACE::Event::CopyConstructor);
+        }
+
+        /// Ресурс забирается у other вместе со строкой
+        Derived(Derived&& other) noexcept :
+        Base(std::move(other)),
+        _number(std::exchange(other._number, 0)),
+        _text(std::move(other._text))
+        {
+            TRACE::Trace(this, TRACE::Event::MoveConstructor);
+        }
+
+        /// Перемещение без копирования, только если у allocator и other один и тот же ресурс, иначе строка копируется в allocator
+        Derived(Derived&& other, const allocator_type& allocator) :
+        Base(std::move(other)),
+        _number(std::exchange(other._number, 0)),
+        _text(std::move(other._text), allocator)
+        {
+            TRACE::Trace(this, TRACE::Event::MoveConstructor);
+        }
+
+        Derived& operator=(const Derived& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            TRACE::Trace(this, TRACE::Event::CopyAssignment);
+            if (this == &other)
+                return *this;
+
+            Base::operator=(other);
+            _number = other._number;
+            _text = other._text;
+            return *this;
+        }
+
+        /// Ресурс не меняется (polymorphic_allocator не распространяется при присваивании), при разных ресурсах строка копируется
+        Derived& operator=(Derived&& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            TRACE::Trace(this, TRACE::Event::MoveAssignment);
+            if (this == &other)
+                return *this;
+
+            Base::operator=(std::move(other));
+            _number = std::exchange(other._number, 0);
+            _text = std::move(other._text);
+            return *this;
+        }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return _text.get_allocator();
+        }
+
+        int _number = 5;
+        std::pmr::string _text;
+    };
+
+    static_assert(std::uses_allocator_v<Derived, Derived::allocator_type>);
+    static_assert(std::is_nothrow_move_constructible_v<Derived>);
+}
+
+#endif /* pmr_h */
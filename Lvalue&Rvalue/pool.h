@@ -0,0 +1,292 @@
+#ifndef pool_h
+#define pool_h
+
+#include "lvalue_rvalue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ Пул переиспользования объектов: вместо удаления объект возвращается в пул, сбрасывается и выдается снова.
+ После перемещения (operator=(Derived&&)) у Derived остается _number = 0 и _text в допустимом, но неопределенном состоянии
+ (у std::string обычно пустой), такой объект обычно сразу удаляется,
+ а следующий создается заново: два выделения памяти (объект и строка длиннее SSO) на каждый цикл.
+ POOL::Pool<T> хранит объекты, а сброс (POOL::Recycler<T>::Reset) оставляет выделенную память строки: _text.clear() не освобождает буфер,
+ поэтому следующий SetText/assign той же длины не выделяет память.
+ - Acquire() возвращает POOL::Handle<T> - владеющий указатель, деструктор которого возвращает объект в пул (RAII).
+ - Каждый поток держит до CACHE объектов в своем кэше без блокировок, лишние уходят пачкой в общий список под мьютексом,
+   пустой кэш берет пачку из общего списка, и только если он пуст - создает объект через new.
+ - Общий список ограничен GLOBAL объектами, сверх него объекты удаляются.
+ {
+     POOL::Handle<Derived> derived = POOL::Pool<Derived>::Acquire(); // _number = 0, _text пустой, емкость прошлого владельца
+     derived->_text.assign(text); // Без выделения памяти, если емкости хватает
+ } // Объект вернулся в кэш потока
+ Handle не должен пережить main: кэш потока - thread_local.
+ */
+namespace POOL
+{
+    /// Объектов в кэше одного потока, половина уходит в общий список при переполнении
+    inline constexpr std::size_t CACHE = 64;
+    /// Объектов в общем списке
+    inline constexpr std::size_t GLOBAL = 1 << 16;
+
+    /// Тип с полями Derived: число и текст с clear(), который сохраняет емкость
+    template<class T>
+    concept Clearable = requires(T& object)
+    {
+        object._number = 0;
+        object._text.clear();
+    };
+
+    /*
+     Сброс объекта перед повторной выдачей, можно специализировать для своего типа, Reset не должен бросать исключения.
+     По умолчанию: Clearable - обнуление числа и очистка текста с сохранением емкости, остальные типы - присваивание T().
+     */
+    template<class T>
+    struct Recycler
+    {
+        static void Reset(T& object) noexcept(Clearable<T> || (std::is_nothrow_move_assignable_v<T> && std::is_nothrow_default_constructible_v<T>))
+        {
+            if constexpr (Clearable<T>)
+            {
+                object._number = 0;
+                object._text.clear();
+            }
+            else
+            {
+                object = T();
+            }
+        }
+    };
+
+    template<class T>
+    class Handle;
+
+    template<class T>
+    class Pool
+    {
+        static_assert(noexcept(Recycler<T>::Reset(std::declval<T&>())), "POOL::Recycler<T>::Reset must not throw");
+
+    public:
+        /// Объект из кэша потока, общего списка или новый, всегда после Recycler<T>::Reset
+        static Handle<T> Acquire()
+        {
+            Cache& cache = Local();
+            if (cache.objects.empty())
+                Refill(cache);
+            if (cache.objects.empty())
+            {
+                T* object = new T();
+                _created.fetch_add(1, std::memory_order_relaxed);
+                Recycler<T>::Reset(*object);
+                return Handle<T>(object);
+            }
+
+            T* object = cache.objects.back();
+            cache.objects.pop_back();
+            return Handle<T>(object);
+        }
+
+        /// Объект, созданный не пулом (например, после перемещения из него), переходит в пул
+        static void Recycle(std::unique_ptr<T> object)
+        {
+            if (object)
+                Release(object.release());
+        }
+
+        /// Объектов, созданных через new за все время
+        static std::size_t Created() noexcept
+        {
+            return _created.load(std::memory_order_relaxed);
+        }
+
+        /// Удаляет объекты общего списка и кэша текущего потока
+        static void Trim() noexcept
+        {
+            if (Cache* cache = TryLocal())
+            {
+                for (T* object : cache->objects)
+                    delete object;
+                cache->objects.clear();
+            }
+
+            Global& global = Shared();
+            std::lock_guard lock(global.mutex);
+            for (T* object : global.objects)
+                delete object;
+            global.objects.clear(); // Емкость GLOBAL остается
+        }
+
+    private:
+        friend class Handle<T>;
+
+        /// Емкость GLOBAL зарезервирована, поэтому возврат объектов не выделяет память и не бросает исключений
+        struct Global
+        {
+            Global()
+            {
+                objects.reserve(GLOBAL);
+            }
+
+            ~Global()
+            {
+                for (T* object : objects)
+                    delete object;
+            }
+
+            std::mutex mutex;
+            std::vector<T*> objects;
+        };
+
+        /// При завершении потока объекты кэша уходят в общий список
+        struct Cache
+        {
+            Cache()
+            {
+                objects.reserve(CACHE);
+            }
+
+            ~Cache()
+            {
+                Flush(*this, objects.size());
+            }
+
+            std::vector<T*> objects;
+        };
+
+        static Cache& Local()
+        {
+            thread_local Cache cache;
+            return cache;
+        }
+
+        /// Кэш потока без исключений: первое обращение потока создает кэш, reserve(CACHE) может бросить, тогда nullptr
+        static Cache* TryLocal() noexcept
+        {
+            try
+            {
+                return &Local();
+            }
+            catch (...)
+            {
+                return nullptr;
+            }
+        }
+
+        static Global& Shared()
+        {
+            static Global global;
+            return global;
+        }
+
+        /// Handle, перемещенный в другой поток, создает там кэш при первом возврате: без памяти под кэш объект удаляется
+        static void Release(T* object) noexcept
+        {
+            Cache* cache = TryLocal();
+            if (!cache)
+            {
+                delete object;
+                return;
+            }
+            Recycler<T>::Reset(*object);
+            if (cache->objects.size() == CACHE)
+                Flush(*cache, CACHE / 2);
+            cache->objects.push_back(object); // Емкость CACHE зарезервирована, выделения памяти нет
+        }
+
+        /// count последних объектов кэша - в общий список, сверх GLOBAL - удаляются
+        static void Flush(Cache& cache, std::size_t count) noexcept
+        {
+            const auto first = cache.objects.end() - static_cast<std::ptrdiff_t>(count);
+            std::size_t moved = 0;
+            {
+                Global& global = Shared();
+                std::lock_guard lock(global.mutex);
+                moved = std::min(count, GLOBAL - global.objects.size());
+                global.objects.insert(global.objects.end(), first, first + static_cast<std::ptrdiff_t>(moved));
+            }
+            for (auto it = first + static_cast<std::ptrdiff_t>(moved); it != cache.objects.end(); ++it)
+                delete *it;
+            cache.objects.erase(first, cache.objects.end());
+        }
+
+        /// Пачка CACHE / 2 объектов из общего списка в пустой кэш
+        static void Refill(Cache& cache)
+        {
+            Global& global = Shared();
+            std::lock_guard lock(global.mutex);
+            const std::size_t count = std::min(CACHE / 2, global.objects.size());
+            const auto first = global.objects.end() - static_cast<std::ptrdiff_t>(count);
+            cache.objects.insert(cache.objects.end(), first, global.objects.end()); // Кэш пуст, емкость CACHE
+            global.objects.erase(first, global.objects.end());
+        }
+
+        static inline std::atomic<std::size_t> _created{0};
+    };
+
+    /// Владеющий указатель на объект пула, как std::unique_ptr, но деструктор возвращает объект в пул
+    template<class T>
+    class Handle
+    {
+    public:
+        Handle() noexcept = default;
+
+        Handle(Handle&& other) noexcept :
+        _object(std::exchange(other._object, nullptr))
+        {
+
+        }
+
+        Handle& operator=(Handle&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            Handle(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        ~Handle()
+        {
+            if (_object)
+                Pool<T>::Release(_object);
+        }
+
+        void swap(Handle& other) noexcept
+        {
+            std::swap(_object, other._object);
+        }
+
+        T& operator*() const noexcept { return *_object; }
+        T* operator->() const noexcept { return _object; }
+        T* get() const noexcept { return _object; }
+        explicit operator bool() const noexcept { return _object; }
+
+        /// Объект больше не принадлежит пулу, как std::unique_ptr::release
+        std::unique_ptr<T> release() noexcept
+        {
+            return std::unique_ptr<T>(std::exchange(_object, nullptr));
+        }
+
+    private:
+        friend class Pool<T>;
+
+        explicit Handle(T* object) noexcept :
+        _object(object)
+        {
+
+        }
+
+        T* _object = nullptr;
+    };
+
+    static_assert(noexcept(Recycler<lvalue_rvalue::Derived>::Reset(std::declval<lvalue_rvalue::Derived&>())));
+}
+
+#endif /* pool_h */
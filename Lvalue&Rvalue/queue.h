@@ -0,0 +1,199 @@
+#ifndef queue_h
+#define queue_h
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/*
+ Ограниченная MPMC очередь (много производителей, много потребителей) без блокировок для передачи владения между потоками.
+ Элементы только перемещаются: push(T&&) и emplace(Args&&...) создают элемент прямо в ячейке кольца, try_pop(T&) забирает его перемещением.
+ Копирование невозможно: push(const T&) удален, а T должен перемещаться без исключений - тип, у которого "перемещение" - это копирование
+ с выделением памяти (только конструктор копирования), не компилируется.
+ Каждая ячейка занимает отдельную кэш-линию, поэтому соседние ячейки, которые пишут разные потоки, не мешают друг другу (false sharing).
+ Алгоритм: номер ячейки (sequence) показывает, чья очередь ее использовать - производителя с позицией pos (sequence == pos)
+ или потребителя (sequence == pos + 1). Позиции производителей и потребителей - атомарные счетчики, ячейка захватывается одним CAS.
+ QUEUE::Ring<std::unique_ptr<Derived>> ring(1024);
+ ring.push(std::make_unique<Derived>());
+ std::unique_ptr<Derived> derived;
+ if (ring.try_pop(derived)) ...
+ */
+namespace QUEUE
+{
+    /// Размер кэш-линии (std::hardware_destructive_interference_size зависит от флагов компиляции и дает предупреждение в GCC)
+    inline constexpr std::size_t CACHE_LINE = 64;
+
+    template<class T>
+    class Ring
+    {
+        static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                      "QUEUE::Ring requires a type with noexcept move: copy-only types are rejected");
+        static_assert(std::is_nothrow_destructible_v<T>, "QUEUE::Ring requires a noexcept destructor");
+
+        struct alignas(CACHE_LINE) Slot
+        {
+            std::atomic<std::size_t> sequence{0};
+            bool empty = false; // Конструктор элемента бросил исключение, потребитель пропускает ячейку
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T* Value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+        };
+
+    public:
+        using value_type = T;
+
+        /// capacity округляется вверх до степени двойки
+        explicit Ring(std::size_t capacity) :
+        _capacity(Round(capacity)),
+        _slots(new Slot[_capacity])
+        {
+            for (std::size_t i = 0; i < _capacity; ++i)
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~Ring()
+        {
+            const std::size_t last = _enqueue.load(std::memory_order_relaxed);
+            for (std::size_t position = _dequeue.load(std::memory_order_relaxed); position != last; ++position)
+            {
+                Slot& slot = _slots[position & (_capacity - 1)];
+                if (!slot.empty)
+                    slot.Value()->~T();
+            }
+        }
+
+        Ring(const Ring&) = delete;
+        Ring& operator=(const Ring&) = delete;
+
+        /// false - очередь заполнена, value не перемещается
+        bool try_push(T&& value)
+        {
+            return try_emplace(std::move(value));
+        }
+
+        bool try_push(const T&) = delete;
+
+        /// Элемент создается в ячейке из args, false - очередь заполнена
+        template<class... Args>
+        bool try_emplace(Args&&... args)
+        {
+            /// lvalue или const T (в том числе std::move(constValue) - const T&& тоже копируется)
+            static_assert(!(sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...) &&
+                            ((std::is_lvalue_reference_v<Args> || std::is_const_v<std::remove_reference_t<Args>>) && ...)),
+                          "QUEUE::Ring never copies its elements: use push(std::move(value))");
+
+            std::size_t position = _enqueue.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true)
+            {
+                slot = &_slots[position & (_capacity - 1)];
+                const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+                if (difference == 0)
+                {
+                    if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = _enqueue.load(std::memory_order_relaxed);
+                }
+            }
+
+            try
+            {
+                ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+                slot->empty = false;
+            }
+            catch (...)
+            {
+                slot->empty = true;
+                slot->sequence.store(position + 1, std::memory_order_release);
+                throw;
+            }
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Ждет свободную ячейку
+        void push(T&& value)
+        {
+            emplace(std::move(value));
+        }
+
+        void push(const T&) = delete;
+
+        template<class... Args>
+        void emplace(Args&&... args)
+        {
+            while (!try_emplace(std::forward<Args>(args)...))
+                std::this_thread::yield();
+        }
+
+        /// Перемещает элемент в value, false - очередь пуста
+        bool try_pop(T& value) noexcept
+        {
+            while (true)
+            {
+                std::size_t position = _dequeue.load(std::memory_order_relaxed);
+                Slot* slot;
+                while (true)
+                {
+                    slot = &_slots[position & (_capacity - 1)];
+                    const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                    if (difference == 0)
+                    {
+                        if (_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (difference < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        position = _dequeue.load(std::memory_order_relaxed);
+                    }
+                }
+
+                const bool empty = slot->empty;
+                if (!empty)
+                {
+                    T* element = slot->Value();
+                    value = std::move(*element);
+                    element->~T();
+                }
+                slot->sequence.store(position + _capacity, std::memory_order_release);
+                if (!empty)
+                    return true;
+            }
+        }
+
+        std::size_t capacity() const noexcept { return _capacity; }
+
+    private:
+        static std::size_t Round(std::size_t capacity) noexcept
+        {
+            std::size_t round = 2;
+            while (round < capacity)
+                round *= 2;
+            return round;
+        }
+
+        const std::size_t _capacity;
+        const std::unique_ptr<Slot[]> _slots;
+        alignas(CACHE_LINE) std::atomic<std::size_t> _enqueue{0};
+        alignas(CACHE_LINE) std::atomic<std::size_t> _dequeue{0};
+    };
+}
+
+#endif /* queue_h */
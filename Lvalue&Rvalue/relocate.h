@@ -0,0 +1,289 @@
+#ifndef relocate_h
+#define relocate_h
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+ Релокация (relocation) - перенос объекта на новый адрес: конструктор перемещения в новом месте + деструктор в старом.
+ Тривиально релоцируемый тип (trivially relocatable) - тип, для которого релокация равна копированию байт (memcpy), а старый объект просто забывается без деструктора.
+ Таких типов больше, чем тривиально копируемых: std::unique_ptr, std::shared_ptr, std::vector, классы без состояния с пользовательскими конструкторами.
+ Не тривиально релоцируемые: объекты, хранящие указатель на себя, например std::string в libstdc++ (указатель на внутренний SSO-буфер).
+ Свойство включается явно (opt-in) специализацией шаблона:
+ template<> struct RELOCATE::is_trivially_relocatable<Example> : std::true_type {};
+ RELOCATE::Vector<T> при росте, вставке и удалении переносит такие типы одним memcpy/memmove, остальные - перемещением и деструктором.
+ */
+namespace RELOCATE
+{
+    /// По умолчанию - только тривиально копируемые типы
+    template<class T>
+    struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+    template<class T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<std::remove_cv_t<T>>::value;
+
+    template<class T, class Deleter>
+    struct is_trivially_relocatable<std::unique_ptr<T, Deleter>> : is_trivially_relocatable<Deleter> {};
+
+    template<class T>
+    struct is_trivially_relocatable<std::default_delete<T>> : std::true_type {};
+
+    template<class T>
+    struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+    /// std::string хранит указатель на свой SSO-буфер в libstdc++, в libc++ и MSVC STL - нет
+    template<>
+    struct is_trivially_relocatable<std::string> : std::bool_constant<
+#if defined(_LIBCPP_VERSION) || defined(_MSVC_STL_VERSION)
+        true
+#else
+        false
+#endif
+    > {};
+
+    /// Перенос одного объекта из source в неинициализированную память destination, source после этого - неинициализированная память
+    template<class T>
+    void relocate_at(T* source, T* destination) noexcept
+    {
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), sizeof(T));
+        }
+        else
+        {
+            static_assert(std::is_nothrow_move_constructible_v<T>, "relocation requires noexcept move constructor");
+            ::new (static_cast<void*>(destination)) T(std::move(*source));
+            source->~T();
+        }
+    }
+
+    /// Перенос [first, last) в destination, диапазоны могут пересекаться (как memmove)
+    template<class T>
+    void relocate(T* first, T* last, T* destination) noexcept
+    {
+        if (first == destination || first == last)
+            return;
+
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            std::memmove(static_cast<void*>(destination), static_cast<const void*>(first), static_cast<std::size_t>(last - first) * sizeof(T));
+        }
+        else if (destination < first)
+        {
+            for (; first != last; ++first, ++destination)
+                relocate_at(first, destination);
+        }
+        else
+        {
+            destination += last - first;
+            while (last != first)
+                relocate_at(--last, --destination);
+        }
+    }
+
+    /*
+     Вектор с релокацией: то же, что std::vector, но перенос элементов при росте, вставке и удалении - relocate().
+     std::vector при росте вызывает для каждого элемента конструктор перемещения и деструктор, при вставке и удалении - оператор присваивания перемещением.
+     Для не тривиально релоцируемых T конструктор перемещения должен быть noexcept.
+     */
+    template<class T>
+    class Vector
+    {
+        static_assert(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+                      "RELOCATE::Vector requires a trivially relocatable type or a noexcept move constructor");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        Vector() noexcept = default;
+
+        /// Делегирование Vector(): объект уже создан, поэтому при исключении из emplace_back деструктор удалит созданные элементы и память
+        Vector(std::initializer_list<T> list) :
+        Vector()
+        {
+            reserve(list.size());
+            for (const T& value : list)
+                emplace_back(value);
+        }
+
+        ~Vector()
+        {
+            clear();
+            Deallocate(_data, _capacity);
+        }
+
+        Vector(const Vector& other) :
+        Vector()
+        {
+            reserve(other._size);
+            for (const T& value : other)
+                emplace_back(value);
+        }
+
+        Vector& operator=(const Vector& other) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            if (this == &other)
+                return *this;
+
+            Vector copy(other);
+            swap(copy);
+            return *this;
+        }
+
+        Vector(Vector&& other) noexcept :
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _capacity(std::exchange(other._capacity, 0))
+        {
+
+        }
+
+        Vector& operator=(Vector&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            if (this == &other)
+                return *this;
+
+            Vector moved(std::move(other));
+            swap(moved);
+            return *this;
+        }
+
+        void swap(Vector& other) noexcept
+        {
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            std::swap(_capacity, other._capacity);
+        }
+
+        T* data() noexcept { return _data; }
+        const T* data() const noexcept { return _data; }
+        size_type size() const noexcept { return _size; }
+        size_type capacity() const noexcept { return _capacity; }
+        bool empty() const noexcept { return _size == 0; }
+
+        iterator begin() noexcept { return _data; }
+        iterator end() noexcept { return _data + _size; }
+        const_iterator begin() const noexcept { return _data; }
+        const_iterator end() const noexcept { return _data + _size; }
+
+        T& operator[](size_type index) noexcept { return _data[index]; }
+        const T& operator[](size_type index) const noexcept { return _data[index]; }
+        T& front() noexcept { return _data[0]; }
+        const T& front() const noexcept { return _data[0]; }
+        T& back() noexcept { return _data[_size - 1]; }
+        const T& back() const noexcept { return _data[_size - 1]; }
+
+        void reserve(size_type capacity)
+        {
+            if (capacity > _capacity)
+                Reallocate(capacity);
+        }
+
+        template<class... Args>
+        T& emplace_back(Args&&... args)
+        {
+            return *emplace(end(), std::forward<Args>(args)...);
+        }
+
+        void push_back(const T& value) { emplace_back(value); }
+        void push_back(T&& value) { emplace_back(std::move(value)); }
+
+        /// Аргументы могут ссылаться на элементы самого вектора, поэтому новый элемент создается до переноса
+        template<class... Args>
+        iterator emplace(const_iterator position, Args&&... args)
+        {
+            const size_type index = static_cast<size_type>(position - _data);
+            if (_size == _capacity)
+            {
+                const size_type capacity = _capacity ? _capacity * 2 : 1;
+                T* data = Allocate(capacity);
+                try
+                {
+                    ::new (static_cast<void*>(data + index)) T(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    Deallocate(data, capacity);
+                    throw;
+                }
+                relocate(_data, _data + index, data);
+                relocate(_data + index, _data + _size, data + index + 1);
+                Deallocate(_data, _capacity);
+                _data = data;
+                _capacity = capacity;
+            }
+            else if (index == _size)
+            {
+                ::new (static_cast<void*>(_data + _size)) T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                alignas(T) unsigned char buffer[sizeof(T)];
+                T* value = ::new (static_cast<void*>(buffer)) T(std::forward<Args>(args)...);
+                relocate(_data + index, _data + _size, _data + index + 1);
+                relocate_at(value, _data + index);
+            }
+            ++_size;
+            return _data + index;
+        }
+
+        iterator insert(const_iterator position, const T& value) { return emplace(position, value); }
+        iterator insert(const_iterator position, T&& value) { return emplace(position, std::move(value)); }
+
+        iterator erase(const_iterator position) noexcept
+        {
+            T* element = _data + (position - _data);
+            element->~T();
+            relocate(element + 1, _data + _size, element);
+            --_size;
+            return element;
+        }
+
+        void pop_back() noexcept
+        {
+            _data[--_size].~T();
+        }
+
+        void clear() noexcept
+        {
+            std::destroy(_data, _data + _size);
+            _size = 0;
+        }
+
+    private:
+        static T* Allocate(size_type capacity)
+        {
+            return std::allocator<T>().allocate(capacity);
+        }
+
+        static void Deallocate(T* data, size_type capacity) noexcept
+        {
+            if (data)
+                std::allocator<T>().deallocate(data, capacity);
+        }
+
+        void Reallocate(size_type capacity)
+        {
+            T* data = Allocate(capacity);
+            relocate(_data, _data + _size, data);
+            Deallocate(_data, _capacity);
+            _data = data;
+            _capacity = capacity;
+        }
+
+        T* _data = nullptr;
+        size_type _size = 0;
+        size_type _capacity = 0;
+    };
+}
+
+#endif /* relocate_h */
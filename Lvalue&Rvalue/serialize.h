@@ -0,0 +1,394 @@
+#ifndef serialize_h
+#define serialize_h
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ Двоичный формат для Derived и любого типа с теми же полями (_number и _text, приводимый к std::string_view):
+ арена строк с префиксом длины и столбцы фиксированной ширины.
+ - SERIALIZE::Writer - потоковая запись: принимает только rvalue, запись перемещается в писателя и уничтожается после записи,
+   строки сразу уходят в файл, в памяти остаются только столбцы (12 байт на запись).
+ - SERIALIZE::View - файл, отображенный в память (mmap) только для чтения: GetText() возвращает std::string_view на арену,
+   загрузка не создает ни одной строки и не выделяет память на запись, страницы читаются при первом обращении.
+ {
+     SERIALIZE::Writer writer("deriveds.bin");
+     for (Derived& derived : deriveds)
+         writer.Write(std::move(derived));
+     writer.Close();
+ }
+ SERIALIZE::View view("deriveds.bin");
+ std::string_view text = view[0].GetText(); // Без копирования
+ Derived derived = view[0].Materialize<Derived>(); // Копия в Derived, если нужен владеющий объект
+ */
+namespace SERIALIZE
+{
+    /// Тип с полями Derived: число и текст
+    template<class T>
+    concept Serializable = requires(const T& record)
+    {
+        { record._number } -> std::convertible_to<std::int32_t>;
+        std::string_view(record._text);
+    };
+
+    /*
+     Формат файла (порядок байт - как в памяти, little-endian на x86 и ARM):
+     Header | арена: для каждой записи uint32 длина и символы без '\0' | до кратного 8 | int32 number[count] | до кратного 8 | uint64 offset[count]
+     offset - смещение длины строки записи от начала арены, столбцы выровнены и читаются из отображения напрямую.
+     */
+    struct Header
+    {
+        char magic[4] = {'L', 'V', 'R', 'S'};
+        std::uint32_t version = 1;
+        std::uint64_t count = 0; // Записей
+        std::uint64_t arena = 0; // Байт арены без выравнивания
+    };
+
+    static_assert(sizeof(Header) == 24);
+
+    namespace detail
+    {
+        constexpr std::uint64_t Align(std::uint64_t offset) noexcept
+        {
+            return (offset + 7) & ~std::uint64_t{7};
+        }
+
+        /// Расположение столбцов в файле по заголовку
+        struct Layout
+        {
+            explicit Layout(const Header& header) noexcept :
+            numbers(Align(sizeof(Header) + header.arena)),
+            offsets(Align(numbers + header.count * sizeof(std::int32_t))),
+            size(offsets + header.count * sizeof(std::uint64_t))
+            {
+
+            }
+
+            std::uint64_t numbers;
+            std::uint64_t offsets;
+            std::uint64_t size;
+        };
+    }
+
+    /// Потоковая запись в файл, при ошибке ввода-вывода - std::runtime_error, при Write или Close после Close() - std::logic_error
+    class Writer
+    {
+    public:
+        explicit Writer(const std::string& path) :
+        _path(path),
+        _file(std::fopen(path.c_str(), "wb"))
+        {
+            if (!_file)
+                throw std::runtime_error("SERIALIZE: cannot open " + path);
+
+            _buffer.reserve(BUFFER);
+            Put(&_header, sizeof(Header));
+        }
+
+        /// Незакрытый файл закрывается, ошибка при этом теряется: для проверки - Close()
+        ~Writer()
+        {
+            if (_file)
+            {
+                try
+                {
+                    Close();
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /// Запись перемещается в писателя: после вызова ее больше нет, копирование const объекта - ошибка компиляции
+        template<Serializable T>
+        void Write(T&& record)
+        {
+            static_assert(!std::is_lvalue_reference_v<T> && !std::is_const_v<T>,
+                          "SERIALIZE::Writer::Write consumes the record: pass std::move(record)");
+
+            Opened();
+            const T consumed(std::move(record));
+            const std::string_view text(consumed._text);
+            if (text.size() > std::numeric_limits<std::uint32_t>::max())
+                throw std::length_error("SERIALIZE: text longer than 4 GB");
+
+            const auto length = static_cast<std::uint32_t>(text.size());
+            const std::uint64_t offset = _header.arena;
+            Put(&length, sizeof(length));
+            Put(text.data(), text.size());
+            _header.arena += sizeof(length) + text.size();
+            _numbers.push_back(static_cast<std::int32_t>(consumed._number));
+            _offsets.push_back(offset);
+        }
+
+        /// Дописывает столбцы и заголовок и закрывает файл (в том числе при ошибке), после Close() запись невозможна
+        void Close()
+        {
+            Opened();
+            struct Closer
+            {
+                ~Closer() { std::fclose(std::exchange(writer._file, nullptr)); }
+                Writer& writer;
+            } closer{*this};
+
+            _header.count = _numbers.size();
+            const detail::Layout layout(_header);
+            const char zeros[8] = {};
+            Put(zeros, layout.numbers - sizeof(Header) - _header.arena);
+            Put(_numbers.data(), _numbers.size() * sizeof(std::int32_t));
+            Put(zeros, layout.offsets - layout.numbers - _numbers.size() * sizeof(std::int32_t));
+            Put(_offsets.data(), _offsets.size() * sizeof(std::uint64_t));
+            Flush();
+            if (std::fseek(_file, 0, SEEK_SET) != 0)
+                Fail();
+            Put(&_header, sizeof(Header));
+            Flush();
+            if (std::fflush(_file) != 0)
+                Fail();
+        }
+
+        std::size_t size() const noexcept { return _numbers.size(); }
+
+    private:
+        /// Запись в собственный буфер: один вызов fwrite на BUFFER байт, а не два на запись
+        void Put(const void* data, std::size_t size)
+        {
+            if (_buffer.size() + size > BUFFER)
+                Flush();
+            if (size > BUFFER)
+            {
+                if (std::fwrite(data, 1, size, _file) != size)
+                    Fail();
+                return;
+            }
+            _buffer.insert(_buffer.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+        }
+
+        void Flush()
+        {
+            if (!_buffer.empty() && std::fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+                Fail();
+            _buffer.clear();
+        }
+
+        /// После Close() файла нет: запись ушла бы в fwrite(..., nullptr)
+        void Opened() const
+        {
+            if (!_file)
+                throw std::logic_error("SERIALIZE: " + _path + " is already closed");
+        }
+
+        [[noreturn]] void Fail() const
+        {
+            throw std::runtime_error("SERIALIZE: cannot write " + _path);
+        }
+
+        static constexpr std::size_t BUFFER = 1 << 20;
+
+        std::string _path;
+        std::FILE* _file;
+        std::vector<char> _buffer;
+        Header _header;
+        std::vector<std::int32_t> _numbers;
+        std::vector<std::uint64_t> _offsets;
+    };
+
+    /// Запись в отображении файла: значения читаются из столбцов и арены без копирования
+    class Row
+    {
+    public:
+        Row(std::int32_t number, const char* text) noexcept :
+        _number(number),
+        _text(text)
+        {
+
+        }
+
+        int GetNumber() const noexcept
+        {
+            return _number;
+        }
+
+        /// Ссылка на арену, живет, пока жив View
+        std::string_view GetText() const noexcept
+        {
+            std::uint32_t length;
+            std::memcpy(&length, _text, sizeof(length)); // Префикс длины не выровнен
+            return {_text + sizeof(length), length};
+        }
+
+        /// Владеющая копия записи, текст создается из std::string_view
+        template<Serializable T>
+        T Materialize() const
+        {
+            T record;
+            record._number = _number;
+            record._text = decltype(record._text)(GetText());
+            return record;
+        }
+
+    private:
+        std::int32_t _number;
+        const char* _text;
+    };
+
+    /// Файл Writer только для чтения, при ошибке открытия или формата - std::runtime_error
+    class View
+    {
+    public:
+        explicit View(const std::string& path)
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+                throw std::runtime_error("SERIALIZE: cannot open " + path);
+
+            struct stat status{};
+            void* mapping = MAP_FAILED;
+            if (::fstat(descriptor, &status) == 0 && status.st_size > 0)
+                mapping = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            ::close(descriptor); // Отображение остается после закрытия файла
+            if (mapping == MAP_FAILED)
+                throw std::runtime_error("SERIALIZE: cannot map " + path);
+
+            _data = static_cast<const char*>(mapping);
+            _size = static_cast<std::size_t>(status.st_size);
+#else
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file)
+                throw std::runtime_error("SERIALIZE: cannot open " + path);
+            char buffer[1 << 16];
+            for (std::size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) != 0;)
+                _buffer.insert(_buffer.end(), buffer, buffer + count);
+            std::fclose(file);
+            _data = _buffer.data();
+            _size = _buffer.size();
+#endif
+            Header header;
+            if (_size < sizeof(Header) || (std::memcpy(&header, _data, sizeof(Header)), std::memcmp(header.magic, "LVRS", 4) != 0) || header.version != 1)
+            {
+                Unmap();
+                throw std::runtime_error("SERIALIZE: " + path + " is not a serialized file");
+            }
+
+            const detail::Layout layout(header);
+            if (header.arena > _size || header.count > _size || layout.size > _size)
+            {
+                Unmap();
+                throw std::runtime_error("SERIALIZE: " + path + " is truncated");
+            }
+
+            _count = static_cast<std::size_t>(header.count);
+            _arena = header.arena;
+            _numbers = reinterpret_cast<const std::int32_t*>(_data + layout.numbers);
+            _offsets = reinterpret_cast<const std::uint64_t*>(_data + layout.offsets);
+        }
+
+        View(View&& other) noexcept :
+        _buffer(std::move(other._buffer)),
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _count(std::exchange(other._count, 0)),
+        _arena(std::exchange(other._arena, 0)),
+        _numbers(std::exchange(other._numbers, nullptr)),
+        _offsets(std::exchange(other._offsets, nullptr))
+        {
+
+        }
+
+        View& operator=(View&& other) noexcept // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            if (this != &other)
+            {
+                Unmap();
+                _buffer = std::move(other._buffer);
+                _data = std::exchange(other._data, nullptr);
+                _size = std::exchange(other._size, 0);
+                _count = std::exchange(other._count, 0);
+                _arena = std::exchange(other._arena, 0);
+                _numbers = std::exchange(other._numbers, nullptr);
+                _offsets = std::exchange(other._offsets, nullptr);
+            }
+            return *this;
+        }
+
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        ~View()
+        {
+            Unmap();
+        }
+
+        std::size_t size() const noexcept { return _count; }
+        bool empty() const noexcept { return _count == 0; }
+
+        /// Длины строк не проверяются: файл записан Writer, для файла из чужого источника - сначала Verify()
+        Row operator[](std::size_t index) const noexcept
+        {
+            return {_numbers[index], _data + sizeof(Header) + _offsets[index]};
+        }
+
+        /// Столбец _number прямо из отображения
+        std::span<const std::int32_t> numbers() const noexcept { return {_numbers, _count}; }
+
+        /// Все строки лежат внутри арены, читает весь столбец смещений и префиксы длин
+        bool Verify() const noexcept
+        {
+            for (std::size_t i = 0; i < _count; ++i)
+            {
+                std::uint32_t length;
+                if (_offsets[i] > _arena || _arena - _offsets[i] < sizeof(length))
+                    return false;
+                std::memcpy(&length, _data + sizeof(Header) + _offsets[i], sizeof(length));
+                if (_arena - _offsets[i] - sizeof(length) < length)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        void Unmap() noexcept
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            if (_data)
+                ::munmap(const_cast<char*>(_data), _size);
+#endif
+            _buffer.clear();
+            _data = nullptr;
+            _size = 0;
+        }
+
+        std::vector<char> _buffer; // Содержимое файла без mmap (Windows)
+        const char* _data = nullptr;
+        std::size_t _size = 0;
+        std::size_t _count = 0;
+        std::uint64_t _arena = 0;
+        const std::int32_t* _numbers = nullptr;
+        const std::uint64_t* _offsets = nullptr;
+    };
+}
+
+#endif /* serialize_h */
@@ -0,0 +1,288 @@
+#ifndef soa_h
+#define soa_h
+
+#include "lvalue_rvalue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ Структура массивов (structure of arrays, SoA): поля Derived хранятся отдельными столбцами _number и _text.
+ В std::vector<Derived> (массив структур, AoS) int лежит рядом с 32-байтной std::string: проход по _number читает из памяти 40 байт ради 4,
+ в SOA::Vector столбец _number непрерывный - 16 чисел на кэш-линию, и цикл по нему собирается в векторные инструкции.
+ Строка таблицы - прокси-ссылка SOA::Row, категория значения строки берется из контейнера, как у std::get для std::tuple:
+ - table[i] - как Derived&: GetNumber() - int&, GetText() - Text&;
+ - std::as_const(table)[i] - как const Derived&: const int&, const Text&;
+ - std::move(table)[i] - как Derived&&: GetText() перемещает строку из столбца, Derived derived = std::move(table)[i] - перемещение строки;
+ - std::move(std::as_const(table))[i] - как const Derived&&: значения, строка копируется.
+ Сама прокси-ссылка - временный объект, поэтому ее собственная категория значения ничего не меняет.
+ SOA::Vector<> table;
+ table.push_back(std::move(derived));           // Поля перемещаются в столбцы
+ std::int64_t sum = SOA::Sum(table.numbers());  // Проход только по столбцу _number
+ Derived last = std::move(table)[table.size() - 1]; // Перемещение строки обратно в Derived
+ */
+namespace SOA
+{
+    /// Строка таблицы: указатели на поля в столбцах, Qualified - ссылка на Derived, поведение которой повторяет строка
+    template<class Text, class Qualified>
+    class Row
+    {
+        using Derived = lvalue_rvalue::BasicDerived<Text>;
+        static constexpr bool constant = std::is_const_v<std::remove_reference_t<Qualified>>;
+        static constexpr bool rvalue = std::is_rvalue_reference_v<Qualified>;
+        using Number = std::conditional_t<constant, const int, int>;
+        using Field = std::conditional_t<constant, const Text, Text>;
+
+    public:
+        Row(Number& number, Field& text) noexcept :
+        _number(&number),
+        _text(&text)
+        {
+
+        }
+
+        /// Как у Derived: для & и const & - ссылка на поле в столбце, для && и const && - значение
+        std::conditional_t<rvalue, int, Number&> GetNumber() const noexcept
+        {
+            return *_number;
+        }
+
+        /// Для && строка перемещается из столбца, для const && - копируется
+        std::conditional_t<rvalue, Text, Field&> GetText() const noexcept(!rvalue || !constant)
+        {
+            if constexpr (rvalue && !constant)
+                return std::move(*_text);
+            else
+                return *_text;
+        }
+
+        int ExtractNumber() const noexcept requires (rvalue && !constant)
+        {
+            return std::exchange(*_number, 0);
+        }
+
+        Text ExtractText() const noexcept requires (rvalue && !constant)
+        {
+            return std::exchange(*_text, {});
+        }
+
+        /// Строка как объект Derived: для && поля перемещаются (в столбцах остается состояние после перемещения), иначе копируются
+        operator Derived() const
+        {
+            Derived derived;
+            if constexpr (rvalue && !constant)
+            {
+                derived._number = ExtractNumber();
+                derived._text = std::move(*_text);
+            }
+            else
+            {
+                derived._number = *_number;
+                derived._text = *_text;
+            }
+            return derived;
+        }
+
+        /// Присваивание меняет поля в столбцах, а не саму ссылку, как у std::vector<bool>::reference
+        const Row& operator=(const Row& other) const requires (!constant) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            *_number = *other._number;
+            *_text = *other._text;
+            return *this;
+        }
+
+        const Row& operator=(const Derived& derived) const requires (!constant) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            *_number = derived._number;
+            *_text = derived._text;
+            return *this;
+        }
+
+        const Row& operator=(Derived&& derived) const noexcept requires (!constant) // Возвращаем ссылку, чтобы потом можно было присвоить
+        {
+            *_number = std::exchange(derived._number, 0);
+            *_text = std::move(derived._text);
+            return *this;
+        }
+
+    private:
+        Number* _number;
+        Field* _text;
+    };
+
+    /// Таблица Derived по столбцам, интерфейс как у std::vector
+    template<class Text = std::string>
+    class Vector
+    {
+    public:
+        using value_type = lvalue_rvalue::BasicDerived<Text>;
+        using reference = Row<Text, value_type&>;
+        using const_reference = Row<Text, const value_type&>;
+
+        std::size_t size() const noexcept { return _numbers.size(); }
+        bool empty() const noexcept { return _numbers.empty(); }
+
+        void reserve(std::size_t capacity)
+        {
+            _numbers.reserve(capacity);
+            _texts.reserve(capacity);
+        }
+
+        void clear() noexcept
+        {
+            _numbers.clear();
+            _texts.clear();
+        }
+
+        void push_back(const value_type& derived)
+        {
+            emplace_back(derived._number, derived._text);
+        }
+
+        /// Поля перемещаются в столбцы, derived - как после перемещения (_number = 0)
+        void push_back(value_type&& derived)
+        {
+            emplace_back(derived._number, std::move(derived._text));
+            derived._number = 0;
+        }
+
+        /// Строка из значений полей, при исключении столбцы остаются одной длины
+        template<class T>
+        void emplace_back(int number, T&& text)
+        {
+            _numbers.push_back(number);
+            try
+            {
+                _texts.emplace_back(std::forward<T>(text));
+            }
+            catch (...)
+            {
+                _numbers.pop_back();
+                throw;
+            }
+        }
+
+        void pop_back() noexcept
+        {
+            _numbers.pop_back();
+            _texts.pop_back();
+        }
+
+        reference operator[](std::size_t index) & noexcept { return {_numbers[index], _texts[index]}; }
+        const_reference operator[](std::size_t index) const & noexcept { return {_numbers[index], _texts[index]}; }
+        Row<Text, value_type&&> operator[](std::size_t index) && noexcept { return {_numbers[index], _texts[index]}; }
+        Row<Text, const value_type&&> operator[](std::size_t index) const && noexcept { return {_numbers[index], _texts[index]}; }
+
+        /// Столбцы для проходов по одному полю
+        std::span<int> numbers() noexcept { return _numbers; }
+        std::span<const int> numbers() const noexcept { return _numbers; }
+        std::span<Text> texts() noexcept { return _texts; }
+        std::span<const Text> texts() const noexcept { return _texts; }
+
+    private:
+        std::vector<int> _numbers;
+        std::vector<Text> _texts;
+    };
+
+    /*
+     Проходы по столбцу: одинаковый код для SoA (SOA::Sum(table.numbers())) и AoS (SOA::Sum(deriveds, &Derived::_number)),
+     отличается только расположение чисел в памяти. LANES независимых аккумуляторов разрывают цепочку зависимых операций:
+     внутренний цикл фиксированной длины -O2 собирает в векторные инструкции (SLP), остаток обрабатывается по одному.
+     */
+    inline constexpr std::size_t LANES = 8;
+
+    template<std::ranges::random_access_range Range, class Projection = std::identity>
+    std::int64_t Sum(const Range& range, Projection projection = {})
+    {
+        const std::size_t size = std::ranges::size(range);
+        std::int64_t lanes[LANES] = {};
+        std::size_t i = 0;
+        for (; i + LANES <= size; i += LANES)
+        {
+            for (std::size_t lane = 0; lane < LANES; ++lane)
+                lanes[lane] += std::invoke(projection, range[i + lane]);
+        }
+
+        std::int64_t sum = 0;
+        for (; i < size; ++i)
+            sum += std::invoke(projection, range[i]);
+        for (std::int64_t lane : lanes)
+            sum += lane;
+        return sum;
+    }
+
+    struct Bounds
+    {
+        int min = std::numeric_limits<int>::max();
+        int max = std::numeric_limits<int>::lowest();
+    };
+
+    /// Наименьшее и наибольшее значение, для пустого диапазона min > max
+    template<std::ranges::random_access_range Range, class Projection = std::identity>
+    Bounds MinMax(const Range& range, Projection projection = {})
+    {
+        const std::size_t size = std::ranges::size(range);
+        Bounds lanes[LANES];
+        std::size_t i = 0;
+        for (; i + LANES <= size; i += LANES)
+        {
+            for (std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                const int value = std::invoke(projection, range[i + lane]);
+                lanes[lane].min = value < lanes[lane].min ? value : lanes[lane].min;
+                lanes[lane].max = value > lanes[lane].max ? value : lanes[lane].max;
+            }
+        }
+
+        Bounds bounds;
+        for (; i < size; ++i)
+        {
+            const int value = std::invoke(projection, range[i]);
+            bounds.min = value < bounds.min ? value : bounds.min;
+            bounds.max = value > bounds.max ? value : bounds.max;
+        }
+        for (const Bounds& lane : lanes)
+        {
+            bounds.min = lane.min < bounds.min ? lane.min : bounds.min;
+            bounds.max = lane.max > bounds.max ? lane.max : bounds.max;
+        }
+        return bounds;
+    }
+
+    /*
+     Индексы строк, для которых predicate(value) == true, без ветвлений: индекс записывается всегда, а счетчик растет на результат сравнения,
+     поэтому непредсказуемое условие не сбрасывает конвейер. indices - буфер вызывающего, переиспользуется между проходами,
+     Index - тип индекса (std::uint32_t вдвое уменьшает запись, если строк меньше 2^32).
+     */
+    template<std::ranges::random_access_range Range, class Predicate, class Index, class Projection = std::identity>
+    std::size_t Filter(const Range& range, Predicate predicate, std::vector<Index>& indices, Projection projection = {})
+    {
+        const std::size_t size = std::ranges::size(range);
+        indices.resize(size);
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            indices[count] = static_cast<Index>(i);
+            count += static_cast<std::size_t>(static_cast<bool>(predicate(std::invoke(projection, range[i]))));
+        }
+        indices.resize(count);
+        return count;
+    }
+
+    static_assert(std::is_same_v<decltype(std::declval<Vector<>&>()[0].GetNumber()), int&>);
+    static_assert(std::is_same_v<decltype(std::declval<const Vector<>&>()[0].GetNumber()), const int&>);
+    static_assert(std::is_same_v<decltype(std::declval<Vector<>&&>()[0].GetText()), std::string>);
+    static_assert(std::is_same_v<decltype(std::declval<const Vector<>&&>()[0].GetText()), std::string>);
+    static_assert(noexcept(std::declval<Vector<>&&>()[0].GetText()) && !noexcept(std::declval<const Vector<>&&>()[0].GetText()));
+    static_assert(!std::is_assignable_v<Vector<>::const_reference, const lvalue_rvalue::Derived&>);
+}
+
+#endif /* soa_h */
@@ -0,0 +1,26 @@
+#include "collector.h"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+/// Итог по файлу COLLECTOR::Collector: ./summarize events.bin
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::cout << COLLECTOR::Summarize(argv[1]);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,15 @@
 #ifndef swap_h
 #define swap_h
 
+#include "relocate.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
 /*
  std::swap - меняет местами два параметра одинаковых типа, используя до C++11 оператор копирования копирования, после C++11 оператор перемещения (std::move).
  До С++11, семантика копирования:
@@ -11,7 +20,7 @@
      a = b;    // две копии объекта b
      b = tmp;  // две копии объекта tmp (т.е. a)
  }
- После С++11, семантика перемещения:
+ После С++11, семантика перемещения (swap_move):
  template<class T>
  void swap(T& a, T& b)
  {
@@ -32,12 +41,173 @@ namespace SWAP
     }
     /// После С++11: семантика перемещения
     template<class T>
-    void swap(T& a, T& b)
+    void swap_move(T& a, T& b) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)
     {
         T tmp = std::move(a);
         a = std::move(b);
         b = std::move(tmp);
     }
+
+    /// Detection idiom: есть ли у T функция-член a.swap(b)
+    template<class T, class = void>
+    struct has_member_swap : std::false_type {};
+
+    template<class T>
+    struct has_member_swap<T, std::void_t<decltype(std::declval<T&>().swap(std::declval<T&>()))>> : std::true_type {};
+
+    template<class T>
+    inline constexpr bool has_member_swap_v = has_member_swap<T>::value;
+
+    /*
+     Обмен байтами вместо присваиваний: тривиально копируемый тип, который можно присвоить.
+     У типа с const полем или полем-ссылкой присваивание удалено (изменять такие поля нельзя, в том числе через memcpy) - как и std::swap, SWAP::swap для него не компилируется.
+     То же для тривиально релоцируемого типа: побайтовый обмен только при наличии присваивания перемещением.
+     */
+    template<class T>
+    inline constexpr bool is_bitwise_swappable_v = std::is_trivially_copyable_v<T> && std::is_trivially_move_assignable_v<T>;
+
+    template<class T>
+    inline constexpr bool is_relocating_swappable_v = RELOCATE::is_trivially_relocatable_v<T> && std::is_move_assignable_v<T>;
+
+    /*
+     Побайтовый обмен блоками по 4 КБ через буфер на стеке.
+     Для блоков такого размера std::memcpy - функция libc, которая при запуске выбирает SIMD-реализацию под процессор (SSE/AVX/AVX-512/NEON), поэтому отдельные intrinsics не нужны.
+     В отличие от swap_move через временный объект T, стек ограничен одним блоком при любом sizeof(T).
+     */
+    inline void swap_bytes(void* a, void* b, std::size_t size) noexcept
+    {
+        constexpr std::size_t BLOCK = 4096;
+        auto* left = static_cast<unsigned char*>(a);
+        auto* right = static_cast<unsigned char*>(b);
+        unsigned char buffer[BLOCK];
+        while (size)
+        {
+            const std::size_t block = size < BLOCK ? size : BLOCK;
+            std::memcpy(buffer, left, block);
+            std::memcpy(left, right, block);
+            std::memcpy(right, buffer, block);
+            size -= block;
+            left += block;
+            right += block;
+        }
+    }
+
+    /// Размер известен при компиляции: для небольших объектов memcpy встраивается в несколько инструкций, буфер не больше самого объекта
+    template<std::size_t Size>
+    void swap_bytes(void* a, void* b) noexcept
+    {
+        constexpr std::size_t BLOCK = Size < 4096 ? Size : 4096;
+        auto* left = static_cast<unsigned char*>(a);
+        auto* right = static_cast<unsigned char*>(b);
+        unsigned char buffer[BLOCK];
+        for (std::size_t offset = 0; offset + BLOCK <= Size; offset += BLOCK)
+        {
+            std::memcpy(buffer, left + offset, BLOCK);
+            std::memcpy(left + offset, right + offset, BLOCK);
+            std::memcpy(right + offset, buffer, BLOCK);
+        }
+        if constexpr (Size % BLOCK != 0)
+            swap_bytes(left + Size - Size % BLOCK, right + Size - Size % BLOCK, Size % BLOCK);
+    }
+
+    namespace detail
+    {
+        /// noexcept того способа, который выберет SWAP::swap: функция-член swap может бросать исключения (например, с аллокатором, который бросает)
+        template<class T>
+        constexpr bool NothrowSwap() noexcept
+        {
+            if constexpr (is_bitwise_swappable_v<T>)
+                return true;
+            else if constexpr (has_member_swap_v<T>)
+                return noexcept(std::declval<T&>().swap(std::declval<T&>()));
+            else if constexpr (is_relocating_swappable_v<T>)
+                return true;
+            else
+                return std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+        }
+    }
+
+    /*
+     Выбор самого дешевого способа обмена при компиляции:
+     1. Тривиально копируемый и присваиваемый тип (int, POD, массивы POD) - побайтовый обмен блоками swap_bytes, значение такого типа полностью определяется его байтами.
+     2. Есть функция-член swap (std::string, std::vector) - обмен указателями внутри объекта без временного объекта.
+     3. Тривиально релоцируемый тип (RELOCATE::is_trivially_relocatable) - тоже побайтовый обмен: объекты просто меняются адресами.
+     4. Иначе - три перемещения через временный объект (swap_move).
+     Для способов 1 и 3 объекты должны быть полными, а не потенциально перекрывающимися подобъектами (базовый класс, поле [[no_unique_address]]):
+     побайтовый обмен затрагивает все sizeof(T) байт, а в хвостовое выравнивание такого подобъекта компилятор может положить другие поля.
+     Для подобъектов - swap_move.
+     */
+    template<class T>
+    void swap(T& a, T& b) noexcept(detail::NothrowSwap<T>())
+    {
+        if constexpr (is_bitwise_swappable_v<T>)
+        {
+            if (&a != &b)
+                swap_bytes<sizeof(T)>(std::addressof(a), std::addressof(b));
+        }
+        else if constexpr (has_member_swap_v<T>)
+        {
+            a.swap(b);
+        }
+        else if constexpr (is_relocating_swappable_v<T>)
+        {
+            if (&a != &b)
+                swap_bytes<sizeof(T)>(std::addressof(a), std::addressof(b));
+        }
+        else
+        {
+            swap_move(a, b);
+        }
+    }
+
+    /// Обмен непрерывных диапазонов [first1, last1) и [first2, first2 + (last1 - first1)), диапазоны не должны пересекаться
+    template<class T>
+    T* swap_ranges(T* first1, T* last1, T* first2) noexcept(noexcept(SWAP::swap(*first1, *first2)))
+    {
+        if constexpr (is_bitwise_swappable_v<T> || (!has_member_swap_v<T> && is_relocating_swappable_v<T>))
+        {
+            const std::size_t count = static_cast<std::size_t>(last1 - first1);
+            swap_bytes(first1, first2, count * sizeof(T));
+            return first2 + count;
+        }
+        else
+        {
+            for (; first1 != last1; ++first1, ++first2)
+                SWAP::swap(*first1, *first2);
+            return first2;
+        }
+    }
+
+    /// Массивы обмениваются одним диапазоном
+    template<class T, std::size_t N>
+    void swap(T (&a)[N], T (&b)[N]) noexcept(noexcept(SWAP::swap_ranges(a, a + N, b)))
+    {
+        SWAP::swap_ranges(a, a + N, b);
+    }
+
+    namespace detail
+    {
+        /// Не тривиально копируемый тип с функцией-членом swap без noexcept
+        struct ThrowingSwap
+        {
+            ThrowingSwap() = default;
+            ThrowingSwap(const ThrowingSwap&) {}
+            ThrowingSwap& operator=(const ThrowingSwap&) { return *this; } // Возвращаем ссылку, чтобы потом можно было присвоить
+            void swap(ThrowingSwap&) {}
+        };
+
+        struct ConstMember
+        {
+            const int value;
+        };
+    }
+
+    /// Исключение из функции-члена swap доходит до вызывающего, а не превращается в std::terminate
+    static_assert(!noexcept(SWAP::swap(std::declval<detail::ThrowingSwap&>(), std::declval<detail::ThrowingSwap&>())));
+    static_assert(!noexcept(SWAP::swap_ranges(std::declval<detail::ThrowingSwap*>(), std::declval<detail::ThrowingSwap*>(), std::declval<detail::ThrowingSwap*>())));
+    static_assert(noexcept(SWAP::swap(std::declval<std::string&>(), std::declval<std::string&>())));
+    /// const поле не перезаписывается побайтово
+    static_assert(!is_bitwise_swappable_v<detail::ConstMember> && !is_relocating_swappable_v<detail::ConstMember>);
 }
 
 #endif /* swap_h */
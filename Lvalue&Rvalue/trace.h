@@ -0,0 +1,240 @@
+#ifndef trace_h
+#define trace_h
+
+#include "collector.h"
+#include "counter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+/*
+ Трассировка жизненного цикла объекта (конструкторы, операторы присваивания, деструктор), режим выбирается при компиляции.
+ Режимы (макрос TRACE_MODE, по умолчанию TRACE_CONSOLE):
+ - TRACE_OFF - ничего не делает, вызов полностью удаляется компилятором.
+ - TRACE_CONSOLE - синхронный вывод в std::cout "[адрес] событие", как в демонстрации main.cpp.
+ - TRACE_COUNTERS - только счетчики COUNTER::Counter<T> (relaxed атомарные операции в слоте своего потока).
+ - TRACE_BUFFERED - событие фиксированного размера записывается в кольцевой буфер потока, вывод происходит вне горячего пути: при вызове Flush() или при завершении потока.
+   При переполнении самые старые события перезаписываются (Dropped()), события после завершения потока (например, деструкторы глобальных объектов) не выводятся.
+ - TRACE_COLLECTOR - событие с временем и номером потока записывается в кольцо потока, фоновый поток пишет их в двоичный файл (collector.h).
+ Использование:
+ #define TRACE_MODE TRACE_COUNTERS // До подключения заголовков
+ #include "lvalue_rvalue.h"
+ Политику можно передать и параметром шаблона:
+ template <class Tracer = TRACE::Tracer> class Example
+ {
+     Example() { Tracer::Trace(this, TRACE::Event::Constructor); }
+ };
+ */
+
+#define TRACE_OFF 0
+#define TRACE_CONSOLE 1
+#define TRACE_COUNTERS 2
+#define TRACE_BUFFERED 3
+#define TRACE_COLLECTOR 4
+
+#ifndef TRACE_MODE
+#define TRACE_MODE TRACE_CONSOLE
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 4096
+#endif
+
+namespace TRACE
+{
+    using COUNTER::Event;
+
+    /// Ничего не делает
+    struct Off
+    {
+        template <class T>
+        static void Trace(const T*, Event) noexcept {}
+
+        template <class T>
+        static void Trace(const T*, Event, const char*) noexcept {}
+    };
+
+    /// Синхронный вывод в std::cout
+    struct Console
+    {
+        template <class T>
+        static void Trace(const T* object, Event event)
+        {
+            std::cout << "[" << object << "] " << COUNTER::Name(event) << "\n";
+        }
+
+        /// message - собственный текст события вместо "[адрес] событие"
+        template <class T>
+        static void Trace(const T*, Event, const char* message)
+        {
+            std::cout << message << "\n";
+        }
+    };
+
+    /// Только счетчики COUNTER::Counter<T>
+    struct Counters
+    {
+        template <class T>
+        static void Trace(const T*, Event event) noexcept
+        {
+            COUNTER::Counter<T>::Add(event);
+        }
+
+        template <class T>
+        static void Trace(const T* object, Event event, const char*) noexcept
+        {
+            Trace(object, event);
+        }
+    };
+
+    /// Кольцевой буфер событий потока
+    struct Buffered
+    {
+        /// Событие фиксированного размера
+        struct Record
+        {
+            const void* object;       // Адрес объекта
+            const char* type;         // Уникальный адрес для каждого типа
+            std::uint32_t event;      // COUNTER::Event
+            std::uint32_t sequence;   // Номер события в потоке
+        };
+
+        /// Получатель событий при Flush(), вызывается вне горячего пути
+        using Sink = void (*)(const Record* records, std::size_t count);
+
+        template <class T>
+        static void Trace(const T* object, Event event) noexcept
+        {
+            Ring& ring = Local();
+            if (!ring.active)
+                Activate(ring);
+
+            if (ring.size == ring.records.size())
+                ++ring.dropped; // Самое старое событие будет перезаписано
+            else
+                ++ring.size;
+
+            ring.records[ring.head] = Record{object, Type<T>(), static_cast<std::uint32_t>(event), ring.sequence++};
+            ring.head = (ring.head + 1) % ring.records.size();
+        }
+
+        template <class T>
+        static void Trace(const T* object, Event event, const char*) noexcept
+        {
+            Trace(object, event);
+        }
+
+        /// Передает накопленные события текущего потока в Sink и очищает буфер
+        static void Flush()
+        {
+            Ring& ring = Local();
+            const std::size_t tail = (ring.head + ring.records.size() - ring.size) % ring.records.size();
+            const std::size_t first = std::min(ring.size, ring.records.size() - tail);
+            if (first)
+                _sink(&ring.records[tail], first);
+            if (ring.size > first)
+                _sink(&ring.records[0], ring.size - first);
+            ring.size = 0;
+        }
+
+        /// Число перезаписанных событий текущего потока
+        static std::size_t Dropped() noexcept
+        {
+            return Local().dropped;
+        }
+
+        static void SetSink(Sink sink) noexcept
+        {
+            _sink = sink ? sink : Print;
+        }
+
+        /// Sink по умолчанию: текстовый вывод в std::cout в формате Console
+        static void Print(const Record* records, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                std::cout << "[" << records[i].object << "] " << COUNTER::Name(static_cast<Event>(records[i].event)) << "\n";
+        }
+
+    private:
+        /// Тривиальный тип: буфер доступен и во время уничтожения глобальных объектов
+        struct Ring
+        {
+            std::array<Record, TRACE_BUFFER_SIZE> records;
+            std::size_t head;
+            std::size_t size;
+            std::size_t dropped;
+            std::uint32_t sequence;
+            bool active;
+        };
+
+        /// При завершении потока сбрасывает его буфер
+        struct Flusher
+        {
+            ~Flusher() { Flush(); }
+        };
+
+        static Ring& Local() noexcept
+        {
+            thread_local Ring ring{};
+            return ring;
+        }
+
+        static void Activate(Ring& ring) noexcept
+        {
+            ring.active = true;
+            thread_local Flusher flusher;
+            (void)flusher;
+        }
+
+        template <class T>
+        static const char* Type() noexcept
+        {
+            static const char type = 0;
+            return &type;
+        }
+
+        static inline Sink _sink = Print;
+    };
+
+#if TRACE_MODE == TRACE_OFF
+    using Tracer = Off;
+#elif TRACE_MODE == TRACE_CONSOLE
+    using Tracer = Console;
+#elif TRACE_MODE == TRACE_COUNTERS
+    using Tracer = Counters;
+#elif TRACE_MODE == TRACE_BUFFERED
+    using Tracer = Buffered;
+#elif TRACE_MODE == TRACE_COLLECTOR
+    using Tracer = COLLECTOR::Collector;
+#else
+#error "Unknown TRACE_MODE"
+#endif
+
+    /// Трассировка выбранной при компиляции политикой
+    template <class T>
+    inline void Trace(const T* object, Event event) noexcept(noexcept(Tracer::Trace(object, event)))
+    {
+        Tracer::Trace(object, event);
+    }
+
+    template <class T>
+    inline void Trace(const T* object, Event event, const char* message) noexcept(noexcept(Tracer::Trace(object, event, message)))
+    {
+        Tracer::Trace(object, event, message);
+    }
+
+    /// Текст без события жизненного цикла (например, какая ref-qualified перегрузка вызвана): выводится только в TRACE_CONSOLE, в остальных режимах вызов удаляется
+    inline void Message(const char* message) noexcept(TRACE_MODE != TRACE_CONSOLE)
+    {
+#if TRACE_MODE == TRACE_CONSOLE
+        std::cout << message << "\n";
+#else
+        (void)message;
+#endif
+    }
+}
+
+#endif /* trace_h */
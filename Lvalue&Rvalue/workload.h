@@ -0,0 +1,260 @@
+#ifndef workload_h
+#define workload_h
+
+#include "forward.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ Многопоточная нагрузка на Derived: как выбор между копированием и перемещением масштабируется на несколько ядер.
+ - Handoff - производители создают Derived и передают потребителям через общую очередь копированием или перемещением.
+   Копирование длинного _text - выделение памяти в одном потоке и освобождение в другом (конкуренция в аллокаторе).
+ - Stealing - планировщик с кражей задач: владение задачей std::unique_ptr<Derived> переходит между потоками без копирования объекта.
+ - FanOut - один объект std::shared_ptr<const Derived> (FORWARD::Make_Shared_Forward) рассылается всем потребителям:
+   каждая копия std::shared_ptr - атомарное изменение счетчика ссылок в одной кэш-линии на все ядра.
+ Каждая функция возвращает контрольную сумму, чтобы компилятор не выбросил работу.
+ */
+namespace WORKLOAD
+{
+    using lvalue_rvalue::Derived;
+
+    enum class Transfer
+    {
+        Copy,
+        Move
+    };
+
+    /// Очередь с блокировкой, Push(value) копирует или перемещает значение в очередь, Pop() перемещает из очереди
+    template<class T>
+    class Queue
+    {
+    public:
+        template<class U>
+        void Push(U&& value)
+        {
+            {
+                std::lock_guard lock(_mutex);
+                _values.push_back(std::forward<U>(value));
+            }
+            _ready.notify_one();
+        }
+
+        /// false - очередь закрыта и пуста
+        bool Pop(T& value)
+        {
+            std::unique_lock lock(_mutex);
+            _ready.wait(lock, [this] { return !_values.empty() || _closed; });
+            if (_values.empty())
+                return false;
+
+            value = std::move(_values.front());
+            _values.pop_front();
+            return true;
+        }
+
+        void Close()
+        {
+            {
+                std::lock_guard lock(_mutex);
+                _closed = true;
+            }
+            _ready.notify_all();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _ready;
+        std::deque<T> _values;
+        bool _closed = false;
+    };
+
+    namespace detail
+    {
+        inline std::uint64_t Checksum(const Derived& derived) noexcept
+        {
+            return static_cast<std::uint64_t>(derived._number) + derived._text.size();
+        }
+
+        /// Первые items % parts частей получают на один элемент больше
+        inline std::size_t Share(std::size_t items, std::size_t parts, std::size_t part) noexcept
+        {
+            return items / parts + (part < items % parts ? 1 : 0);
+        }
+    }
+
+    /// threads / 2 производителей и столько же потребителей (не меньше одного), всего items объектов
+    inline std::uint64_t Handoff(std::size_t threads, std::size_t items, Transfer transfer, const std::string& text)
+    {
+        const std::size_t producers = std::max<std::size_t>(1, threads / 2);
+        const std::size_t consumers = std::max<std::size_t>(1, threads - producers);
+
+        Queue<Derived> queue;
+        std::atomic<std::uint64_t> checksum{0};
+        std::vector<std::thread> workers;
+        workers.reserve(producers + consumers);
+
+        for (std::size_t i = 0; i < consumers; ++i)
+        {
+            workers.emplace_back([&queue, &checksum]
+            {
+                std::uint64_t local = 0;
+                Derived derived;
+                while (queue.Pop(derived))
+                    local += detail::Checksum(derived);
+                checksum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        std::vector<std::thread> producing;
+        producing.reserve(producers);
+        for (std::size_t i = 0; i < producers; ++i)
+        {
+            producing.emplace_back([&queue, &text, transfer, count = detail::Share(items, producers, i)]
+            {
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    Derived derived;
+                    derived.SetText(text);
+                    if (transfer == Transfer::Move)
+                        queue.Push(std::move(derived));
+                    else
+                        queue.Push(derived);
+                }
+            });
+        }
+
+        for (std::thread& producer : producing)
+            producer.join();
+        queue.Close();
+        for (std::thread& worker : workers)
+            worker.join();
+        return checksum.load(std::memory_order_relaxed);
+    }
+
+    /*
+     Все задачи создаются в очереди потока 0, остальные потоки крадут их с другого конца очереди:
+     владелец берет с конца (последние задачи горячие в кэше), вор - с начала, поэтому они реже конкурируют за одни и те же задачи.
+     */
+    inline std::uint64_t Stealing(std::size_t threads, std::size_t tasks, const std::string& text)
+    {
+        threads = std::max<std::size_t>(1, threads);
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<std::unique_ptr<Derived>> tasks;
+        };
+
+        std::vector<Worker> workers(threads);
+        for (std::size_t i = 0; i < tasks; ++i)
+        {
+            std::unique_ptr<Derived> task = FORWARD::Make_Unique<Derived>();
+            task->SetText(text);
+            workers[0].tasks.push_back(std::move(task));
+        }
+
+        std::atomic<std::size_t> remaining{tasks};
+        std::atomic<std::uint64_t> checksum{0};
+
+        const auto take = [&workers](std::size_t index, bool own) -> std::unique_ptr<Derived>
+        {
+            Worker& worker = workers[index];
+            std::lock_guard lock(worker.mutex);
+            if (worker.tasks.empty())
+                return nullptr;
+
+            std::unique_ptr<Derived> task;
+            if (own)
+            {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            }
+            return task;
+        };
+
+        std::vector<std::thread> running;
+        running.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            running.emplace_back([&, i]
+            {
+                std::uint64_t local = 0;
+                while (remaining.load(std::memory_order_acquire))
+                {
+                    std::unique_ptr<Derived> task = take(i, true);
+                    for (std::size_t j = 1; !task && j < threads; ++j)
+                        task = take((i + j) % threads, false);
+
+                    if (!task)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    local += detail::Checksum(*task);
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                checksum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        for (std::thread& thread : running)
+            thread.join();
+        return checksum.load(std::memory_order_relaxed);
+    }
+
+    /// Вызывающий поток создает items объектов и рассылает каждый всем threads потребителям копией std::shared_ptr
+    inline std::uint64_t FanOut(std::size_t threads, std::size_t items, const std::string& text)
+    {
+        threads = std::max<std::size_t>(1, threads);
+
+        std::vector<Queue<std::shared_ptr<const Derived>>> queues(threads);
+        std::atomic<std::uint64_t> checksum{0};
+        std::vector<std::thread> consumers;
+        consumers.reserve(threads);
+        for (auto& queue : queues)
+        {
+            consumers.emplace_back([&queue, &checksum]
+            {
+                std::uint64_t local = 0;
+                std::shared_ptr<const Derived> derived;
+                while (queue.Pop(derived))
+                    local += detail::Checksum(*derived);
+                checksum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+
+        for (std::size_t i = 0; i < items; ++i)
+        {
+            std::shared_ptr<Derived> derived = FORWARD::Make_Shared_Forward<Derived>();
+            derived->SetText(text);
+            std::shared_ptr<const Derived> shared = std::move(derived);
+            for (auto& queue : queues)
+                queue.Push(shared); // Копия std::shared_ptr - атомарный инкремент счетчика ссылок
+        }
+
+        for (auto& queue : queues)
+            queue.Close();
+        for (std::thread& consumer : consumers)
+            consumer.join();
+        return checksum.load(std::memory_order_relaxed);
+    }
+}
+
+#endif /* workload_h */